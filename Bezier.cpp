@@ -0,0 +1,93 @@
+// ==========================================================================
+// Degree-Specialized Bezier Kernels
+//
+// See Bezier.h for an overview of the Bezier kernels.
+// ==========================================================================
+
+#include "Bezier.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    struct BoundsVisitor
+    {
+        float   lower[2];
+        float   upper[2];
+        bool    empty;
+
+        BoundsVisitor() : empty(true)
+        {
+            lower[0] = lower[1] = upper[0] = upper[1] = 0.f;
+        }
+
+        template <unsigned int Degree>
+        void Segments(const float *xy, size_t count)
+        {
+            for (size_t s = 0; s < count; ++s)
+            {
+                float segmentLower[2], segmentUpper[2];
+                Bezier<Degree>::Bounds(xy + s * 2 * (Degree + 1), segmentLower, segmentUpper);
+
+                if (empty) {
+                    lower[0] = segmentLower[0];
+                    lower[1] = segmentLower[1];
+                    upper[0] = segmentUpper[0];
+                    upper[1] = segmentUpper[1];
+                    empty = false;
+                    continue;
+                }
+                lower[0] = min(lower[0], segmentLower[0]);
+                lower[1] = min(lower[1], segmentLower[1]);
+                upper[0] = max(upper[0], segmentUpper[0]);
+                upper[1] = max(upper[1], segmentUpper[1]);
+            }
+        }
+    };
+
+    struct CubicVisitor
+    {
+        vector<float>  *xy;
+
+        template <unsigned int Degree>
+        void Segments(const float *points, size_t count)
+        {
+            for (size_t s = 0; s < count; ++s)
+            {
+                float cubic[8];
+                Bezier<Degree>::ToCubic(points + s * 2 * (Degree + 1), cubic);
+                xy->insert(xy->end(), cubic, cubic + 8);
+            }
+        }
+    };
+}
+
+// --------------------------------------------------------------------------
+
+bool GlyphBounds(const MyPackedGlyph &glyph, float *lower, float *upper)
+{
+    if (glyph.Empty()) return false;
+
+    BoundsVisitor bounds;
+    VisitByDegree(glyph, bounds);
+    if (bounds.empty) return false;
+
+    lower[0] = bounds.lower[0];
+    lower[1] = bounds.lower[1];
+    upper[0] = bounds.upper[0];
+    upper[1] = bounds.upper[1];
+    return true;
+}
+
+size_t AppendCubics(const MyPackedGlyph &glyph, vector<float> &xy)
+{
+    size_t before = xy.size();
+    CubicVisitor cubics;
+    cubics.xy = &xy;
+    VisitByDegree(glyph, cubics);
+    return (xy.size() - before) / 8;
+}
+
+// --------------------------------------------------------------------------
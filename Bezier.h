@@ -0,0 +1,603 @@
+// ==========================================================================
+// Degree-Specialized Bezier Kernels
+//
+// Bezier<1>, Bezier<2> and Bezier<3> hold the operations on line,
+// quadratic and cubic segments, each compiled for its degree so that loops
+// over control points unroll and no code branches on the degree:
+//  - evaluation in Bernstein form, matching tessEval.glsl
+//  - evaluation on an even grid of t by forward differencing
+//  - tight bounding boxes, splitting, degree elevation and flattening
+//  - distance from a point to the nearest point of a segment
+// Segments are (Degree + 1) consecutive x,y control point pairs, as stored
+// in packed glyphs and patch buffers.
+//
+// VisitByDegree hands each degree bucket of a packed glyph to a visitor
+// with the degree as a template argument. Packed glyphs sort their segments
+// by degree once, when they are built, so the only choice of degree is made
+// per bucket rather than per segment.
+// ==========================================================================
+#ifndef BEZIER_H
+#define BEZIER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "GlyphExtractor.h"
+
+// --------------------------------------------------------------------------
+
+// deepest subdivision used when flattening (see BezierFlatten.h)
+const int BEZIER_MAX_DEPTH = 16;
+
+// n choose k, in k steps so that it stays cheap if it is not folded
+constexpr unsigned int Binomial(unsigned int n, unsigned int k)
+{
+    return k == 0 ? 1 : Binomial(n, k - 1) * (n - k + 1) / k;
+}
+
+// x to the n, for small constant n
+constexpr float Power(float x, unsigned int n)
+{
+    return n == 0 ? 1.f : x * Power(x, n - 1);
+}
+
+// Real roots of a t^3 + b t^2 + c t + d = 0, dropping to a quadratic or
+// linear equation when the leading coefficients vanish; returns how many
+// roots were written, at most 3
+inline unsigned int SolveCubic(double a, double b, double c, double d, double *roots)
+{
+    const double EPSILON = 1e-12;
+    double scale = std::fabs(a) + std::fabs(b) + std::fabs(c) + std::fabs(d);
+
+    if (std::fabs(a) <= EPSILON * scale)
+    {
+        if (std::fabs(b) <= EPSILON * scale)
+        {
+            if (std::fabs(c) <= EPSILON * scale) return 0;
+            roots[0] = -d / c;
+            return 1;
+        }
+
+        double discriminant = c*c - 4.0*b*d;
+        if (discriminant < 0.0) return 0;
+        double root = std::sqrt(discriminant);
+        roots[0] = (-c - root) / (2.0*b);
+        roots[1] = (-c + root) / (2.0*b);
+        return 2;
+    }
+
+    // depressed cubic x^3 + p x + q = 0, with t = x - b / 3
+    b /= a;
+    c /= a;
+    d /= a;
+    double shift = b / 3.0;
+    double p = c - b*shift;
+    double q = 2.0*shift*shift*shift - shift*c + d;
+    double discriminant = q*q / 4.0 + p*p*p / 27.0;
+
+    if (discriminant > 0.0)
+    {
+        double root = std::sqrt(discriminant);
+        roots[0] = std::cbrt(-q / 2.0 + root) + std::cbrt(-q / 2.0 - root) - shift;
+        return 1;
+    }
+    if (p >= 0.0)
+    {
+        roots[0] = -shift;
+        return 1;
+    }
+
+    // three real roots, by the trigonometric method
+    double r = std::sqrt(-p / 3.0);
+    double phi = std::acos(std::min(std::max(-q / (2.0*r*r*r), -1.0), 1.0));
+    const double THIRD_TURN = 2.0943951023931957;
+    for (unsigned int k = 0; k < 3; ++k)
+        roots[k] = 2.0*r*std::cos(phi / 3.0 - k*THIRD_TURN) - shift;
+    return 3;
+}
+
+template <unsigned int Degree> struct BezierExtrema;
+
+template <unsigned int Degree>
+struct Bezier
+{
+    static const unsigned int POINTS = Degree + 1;
+
+    // Bernstein coefficient of control point i
+    static constexpr float Coefficient(unsigned int i)
+    {
+        return float(Binomial(Degree, i));
+    }
+
+    // Bernstein weight of control point i at parameter t
+    static constexpr float Weight(unsigned int i, float t)
+    {
+        return Coefficient(i) * Power(1.f - t, Degree - i) * Power(t, i);
+    }
+
+    // all POINTS weights at parameter t
+    static void Weights(float t, float *weights)
+    {
+        for (unsigned int i = 0; i <= Degree; ++i)
+            weights[i] = Weight(i, t);
+    }
+
+    static void Evaluate(const float *xy, float t, float *point)
+    {
+        float x = 0.f, y = 0.f;
+        for (unsigned int i = 0; i <= Degree; ++i)
+        {
+            float w = Weight(i, t);
+            x += w * xy[2*i];
+            y += w * xy[2*i + 1];
+        }
+        point[0] = x;
+        point[1] = y;
+    }
+
+    // -----------------------------------------------------------------------
+    // Walks a segment at t = 0, 1/steps ... 1 with Degree additions per
+    // coordinate for every point after the first. The table of forward
+    // differences is built from the segment's power basis coefficients and
+    // kept in double: differencing float samples instead loses digits to
+    // cancellation, and the stepping multiplies the loss by about steps to
+    // the Degree. With 0 steps the walk stays at t = 0.
+
+    class ForwardDifferencer
+    {
+        // the current point, then its first to Degree-th forward differences
+        double m_x[POINTS];
+        double m_y[POINTS];
+
+    public:
+        ForwardDifferencer(const float *xy, unsigned int steps)
+        {
+            // power basis: the curve is the sum of a[k] t^k, where a[k] is
+            // C(Degree, k) times the k-th difference of the control points
+            double ax[POINTS], ay[POINTS];
+            for (unsigned int k = 0; k <= Degree; ++k)
+            {
+                ax[k] = ay[k] = 0.0;
+                for (unsigned int i = 0; i <= k; ++i)
+                {
+                    double sign = (k - i) % 2 ? -1.0 : 1.0;
+                    ax[k] += sign * Binomial(k, i) * xy[2*i];
+                    ay[k] += sign * Binomial(k, i) * xy[2*i + 1];
+                }
+                ax[k] *= Binomial(Degree, k);
+                ay[k] *= Binomial(Degree, k);
+            }
+
+            // the j-th difference of t^k over steps of h is h^k times that
+            // of x^k over steps of 1, an exact integer
+            double h = steps > 0 ? 1.0 / steps : 0.0;
+            for (unsigned int j = 0; j <= Degree; ++j)
+            {
+                m_x[j] = m_y[j] = 0.0;
+                double hk = 1.0;
+                for (unsigned int k = 0; k <= Degree; ++k, hk *= h)
+                {
+                    double difference = 0.0;
+                    for (unsigned int i = 0; i <= j; ++i)
+                    {
+                        double sign = (j - i) % 2 ? -1.0 : 1.0;
+                        difference += sign * Binomial(j, i) * Power(float(i), k);
+                    }
+                    m_x[j] += ax[k] * hk * difference;
+                    m_y[j] += ay[k] * hk * difference;
+                }
+            }
+        }
+
+        void Point(float *point) const
+        {
+            point[0] = float(m_x[0]);
+            point[1] = float(m_y[0]);
+        }
+
+        void Step()
+        {
+            for (unsigned int k = 0; k < Degree; ++k) {
+                m_x[k] += m_x[k + 1];
+                m_y[k] += m_y[k + 1];
+            }
+        }
+    };
+
+    // writes steps + 1 points at t = 0, 1/steps ... 1
+    static void EvaluateGrid(const float *xy, unsigned int steps, float *points)
+    {
+        ForwardDifferencer walker(xy, steps);
+        for (unsigned int j = 0; j <= steps; ++j)
+        {
+            walker.Point(points + 2*j);
+            walker.Step();
+        }
+    }
+
+    // -----------------------------------------------------------------------
+
+    // smallest box containing the curve, found from the end points and the
+    // places where the curve turns around in x or y
+    static void Bounds(const float *xy, float *lower, float *upper)
+    {
+        lower[0] = upper[0] = xy[0];
+        lower[1] = upper[1] = xy[1];
+        Include(xy + 2*Degree, lower, upper);
+
+        for (unsigned int axis = 0; axis < 2; ++axis)
+        {
+            float t[2];
+            unsigned int count = BezierExtrema<Degree>::Find(xy + axis, t);
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                float point[2];
+                Evaluate(xy, t[i], point);
+                Include(point, lower, upper);
+            }
+        }
+    }
+
+    // de Casteljau subdivision at t; left and right each get POINTS points
+    static void Split(const float *xy, float t, float *left, float *right)
+    {
+        float work[2 * POINTS];
+        for (unsigned int i = 0; i < 2 * POINTS; ++i)
+            work[i] = xy[i];
+
+        left[0] = work[0];
+        left[1] = work[1];
+        right[2*Degree] = work[2*Degree];
+        right[2*Degree + 1] = work[2*Degree + 1];
+
+        for (unsigned int level = 1; level <= Degree; ++level)
+        {
+            for (unsigned int i = 0; i + level <= Degree; ++i) {
+                work[2*i]     += t * (work[2*i + 2] - work[2*i]);
+                work[2*i + 1] += t * (work[2*i + 3] - work[2*i + 1]);
+            }
+
+            unsigned int last = Degree - level;
+            left[2*level]       = work[0];
+            left[2*level + 1]   = work[1];
+            right[2*last]       = work[2*last];
+            right[2*last + 1]   = work[2*last + 1];
+        }
+    }
+
+    // the same curve with one more control point
+    static void Elevate(const float *xy, float *elevated)
+    {
+        elevated[0] = xy[0];
+        elevated[1] = xy[1];
+        for (unsigned int i = 1; i <= Degree; ++i)
+        {
+            float a = float(i) / (Degree + 1);
+            elevated[2*i]     = a * xy[2*i - 2] + (1.f - a) * xy[2*i];
+            elevated[2*i + 1] = a * xy[2*i - 1] + (1.f - a) * xy[2*i + 1];
+        }
+        elevated[2*Degree + 2] = xy[2*Degree];
+        elevated[2*Degree + 3] = xy[2*Degree + 1];
+    }
+
+    // the same curve as a cubic of 4 control points
+    static void ToCubic(const float *xy, float *cubic);
+
+    // -----------------------------------------------------------------------
+
+    // whether every inner control point is within tolerance of the chord,
+    // which keeps the whole curve within tolerance of it
+    static bool IsFlat(const float *xy, float tolerance2)
+    {
+        const float *end = xy + 2*Degree;
+        float dx = end[0] - xy[0];
+        float dy = end[1] - xy[1];
+        float length2 = dx*dx + dy*dy;
+
+        for (unsigned int i = 1; i < Degree; ++i)
+        {
+            float px = xy[2*i] - xy[0];
+            float py = xy[2*i + 1] - xy[1];
+            float t = length2 > 0.f ? (px*dx + py*dy) / length2 : 0.f;
+            t = std::min(std::max(t, 0.f), 1.f);
+
+            float ex = px - t*dx;
+            float ey = py - t*dy;
+            if (ex*ex + ey*ey > tolerance2)
+                return false;
+        }
+        return true;
+    }
+
+    // writes the polyline of the segment, leaving out its first point, by
+    // halving it until every piece is flat; returns the number of points in
+    // the polyline and writes at most capacity of them
+    static size_t Flatten(const float *xy, float tolerance, float *points, size_t capacity)
+    {
+        struct Piece
+        {
+            float   xy[2 * POINTS];
+            int     depth;
+        };
+
+        size_t count = 0;
+        float tolerance2 = tolerance * tolerance;
+
+        // pieces waiting to be flattened, left-most on top; every split
+        // takes one piece off and puts two on, so the stack never holds more
+        // than one piece per level of subdivision
+        Piece stack[BEZIER_MAX_DEPTH + 1];
+        for (unsigned int i = 0; i < 2 * POINTS; ++i)
+            stack[0].xy[i] = xy[i];
+        stack[0].depth = 0;
+        int top = 1;
+
+        while (top > 0)
+        {
+            Piece piece = stack[--top];
+
+            if (piece.depth == BEZIER_MAX_DEPTH || IsFlat(piece.xy, tolerance2))
+            {
+                // one straight step to the end of the piece
+                if (count < capacity) {
+                    points[2*count]     = piece.xy[2*Degree];
+                    points[2*count + 1] = piece.xy[2*Degree + 1];
+                }
+                ++count;
+                continue;
+            }
+
+            Piece &right = stack[top];
+            Piece &left = stack[top + 1];
+            Split(piece.xy, 0.5f, left.xy, right.xy);
+            left.depth = right.depth = piece.depth + 1;
+            top += 2;
+        }
+
+        return count;
+    }
+
+    // -----------------------------------------------------------------------
+    // Squared distance from a point to the nearest point of the segment,
+    // writing the parameter of that point to nearest if it is given. Lines
+    // are projected directly, and quadratics solve the cubic
+    // (B(t) - p) . B'(t) = 0 in closed form. Cubics run a few steps of
+    // Newton's method on that equation from evenly spaced starting
+    // parameters. The end points are always candidates.
+
+    static float Distance2(const float *xy, const float *point, float *nearest = 0)
+    {
+        float bestT = 0.f;
+        float best = Distance2At(xy, point, 0.f);
+        Consider(xy, point, 1.f, best, bestT);
+
+        if (Degree == 1)
+        {
+            float dx = xy[2] - xy[0], dy = xy[3] - xy[1];
+            float length2 = dx*dx + dy*dy;
+            if (length2 > 0.f)
+                Consider(xy, point, ((point[0] - xy[0])*dx + (point[1] - xy[1])*dy) / length2,
+                         best, bestT);
+        }
+        else if (Degree == 2)
+        {
+            // B(t) - p = a t^2 + 2 b t + m, and B'(t) / 2 = a t + b
+            double ax = xy[0] - 2.0*xy[2] + xy[4], ay = xy[1] - 2.0*xy[3] + xy[5];
+            double bx = xy[2] - xy[0], by = xy[3] - xy[1];
+            double mx = xy[0] - point[0], my = xy[1] - point[1];
+
+            double roots[3];
+            unsigned int count = SolveCubic(ax*ax + ay*ay, 3.0 * (ax*bx + ay*by),
+                                            2.0 * (bx*bx + by*by) + ax*mx + ay*my,
+                                            bx*mx + by*my, roots);
+            for (unsigned int i = 0; i < count; ++i)
+                Consider(xy, point, float(roots[i]), best, bestT);
+        }
+        else
+        {
+            const unsigned int STARTS = Degree + 2;
+            const unsigned int STEPS = 4;
+
+            // control points of the first and second derivatives
+            float first[2 * Degree], second[2 * Degree];
+            for (unsigned int i = 0; i < Degree; ++i) {
+                first[2*i]     = Degree * (xy[2*i + 2] - xy[2*i]);
+                first[2*i + 1] = Degree * (xy[2*i + 3] - xy[2*i + 1]);
+            }
+            for (unsigned int i = 0; i + 1 < Degree; ++i) {
+                second[2*i]     = (Degree - 1) * (first[2*i + 2] - first[2*i]);
+                second[2*i + 1] = (Degree - 1) * (first[2*i + 3] - first[2*i + 1]);
+            }
+
+            for (unsigned int s = 0; s < STARTS; ++s)
+            {
+                float t = float(s) / (STARTS - 1);
+                for (unsigned int step = 0; step < STEPS; ++step)
+                {
+                    float b[2], d1[2], d2[2];
+                    Evaluate(xy, t, b);
+                    EvaluatePoints(first, Degree, t, d1);
+                    EvaluatePoints(second, Degree - 1, t, d2);
+
+                    float ex = b[0] - point[0];
+                    float ey = b[1] - point[1];
+                    float f = ex*d1[0] + ey*d1[1];
+                    float slope = d1[0]*d1[0] + d1[1]*d1[1] + ex*d2[0] + ey*d2[1];
+                    if (slope == 0.f) break;
+                    t = std::min(std::max(t - f / slope, 0.f), 1.f);
+                }
+                Consider(xy, point, t, best, bestT);
+            }
+        }
+
+        if (nearest) *nearest = bestT;
+        return best;
+    }
+
+private:
+    static float Distance2At(const float *xy, const float *point, float t)
+    {
+        float b[2];
+        Evaluate(xy, t, b);
+        return (b[0] - point[0])*(b[0] - point[0]) + (b[1] - point[1])*(b[1] - point[1]);
+    }
+
+    // keeps t if it is in [0, 1] and closer than the best so far
+    static void Consider(const float *xy, const float *point, float t, float &best, float &bestT)
+    {
+        if (!(t >= 0.f && t <= 1.f)) return;
+        float distance2 = Distance2At(xy, point, t);
+        if (distance2 < best) {
+            best = distance2;
+            bestT = t;
+        }
+    }
+
+    // de Casteljau evaluation of count control points, for derivatives
+    static void EvaluatePoints(const float *xy, unsigned int count, float t, float *point)
+    {
+        float work[2 * POINTS];
+        for (unsigned int i = 0; i < 2 * count; ++i)
+            work[i] = xy[i];
+
+        for (unsigned int level = 1; level < count; ++level)
+        {
+            for (unsigned int i = 0; i + level < count; ++i) {
+                work[2*i]     += t * (work[2*i + 2] - work[2*i]);
+                work[2*i + 1] += t * (work[2*i + 3] - work[2*i + 1]);
+            }
+        }
+        point[0] = work[0];
+        point[1] = work[1];
+    }
+
+    static void Include(const float *point, float *lower, float *upper)
+    {
+        lower[0] = std::min(lower[0], point[0]);
+        lower[1] = std::min(lower[1], point[1]);
+        upper[0] = std::max(upper[0], point[0]);
+        upper[1] = std::max(upper[1], point[1]);
+    }
+};
+
+// --------------------------------------------------------------------------
+// Parameters in (0, 1) where one coordinate of a segment has a zero
+// derivative. Coordinates are read every second float, so that x and y of
+// interleaved control points can be handled alike; returns how many were
+// written to t.
+
+template <>
+struct BezierExtrema<1>
+{
+    static unsigned int Find(const float *, float *)
+    {
+        return 0;
+    }
+};
+
+template <>
+struct BezierExtrema<2>
+{
+    static unsigned int Find(const float *c, float *t)
+    {
+        // the derivative is linear, from P1 - P0 to P2 - P1
+        float d0 = c[2] - c[0];
+        float d1 = c[4] - c[2];
+        if (d0 == d1) return 0;
+
+        float root = d0 / (d0 - d1);
+        if (root <= 0.f || root >= 1.f) return 0;
+        t[0] = root;
+        return 1;
+    }
+};
+
+template <>
+struct BezierExtrema<3>
+{
+    static unsigned int Find(const float *c, float *t)
+    {
+        // the derivative is a quadratic a t^2 + b t + k
+        float d0 = c[2] - c[0];
+        float d1 = c[4] - c[2];
+        float d2 = c[6] - c[4];
+        float a = d0 - 2.f*d1 + d2;
+        float b = 2.f * (d1 - d0);
+        float k = d0;
+
+        float roots[2];
+        unsigned int found = 0;
+        if (std::fabs(a) < 1e-12f) {
+            if (b != 0.f) roots[found++] = -k / b;
+        }
+        else {
+            float discriminant = b*b - 4.f*a*k;
+            if (discriminant >= 0.f) {
+                float root = std::sqrt(discriminant);
+                roots[found++] = (-b + root) / (2.f*a);
+                roots[found++] = (-b - root) / (2.f*a);
+            }
+        }
+
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < found; ++i)
+            if (roots[i] > 0.f && roots[i] < 1.f) t[count++] = roots[i];
+        return count;
+    }
+};
+
+// --------------------------------------------------------------------------
+// Degree elevation up to a cubic, one degree at a time
+
+template <unsigned int Degree>
+struct BezierToCubic
+{
+    static void Apply(const float *xy, float *cubic)
+    {
+        float elevated[2 * (Degree + 2)];
+        Bezier<Degree>::Elevate(xy, elevated);
+        BezierToCubic<Degree + 1>::Apply(elevated, cubic);
+    }
+};
+
+template <>
+struct BezierToCubic<3>
+{
+    static void Apply(const float *xy, float *cubic)
+    {
+        std::copy(xy, xy + 8, cubic);
+    }
+};
+
+template <unsigned int Degree>
+void Bezier<Degree>::ToCubic(const float *xy, float *cubic)
+{
+    BezierToCubic<Degree>::Apply(xy, cubic);
+}
+
+// --------------------------------------------------------------------------
+// Calls visitor.template Segments<Degree>(xy, count) for the lines, then the
+// quadratics, then the cubics of a packed glyph. Within each call the degree
+// is a compile-time constant.
+
+template <class Visitor>
+void VisitByDegree(const MyPackedGlyph &glyph, Visitor &visitor)
+{
+    visitor.template Segments<1>(glyph.Points(1), glyph.SegmentCount(1));
+    visitor.template Segments<2>(glyph.Points(2), glyph.SegmentCount(2));
+    visitor.template Segments<3>(glyph.Points(3), glyph.SegmentCount(3));
+}
+
+// tight bounding box of a glyph's outline; returns false, leaving the box
+// untouched, if the glyph has no segments
+bool GlyphBounds(const MyPackedGlyph &glyph, float *lower, float *upper);
+
+// appends a glyph's segments to xy elevated to cubic patches of 4 x,y
+// points each, lines first, then quadratics, then cubics; returns the
+// number of patches added
+size_t AppendCubics(const MyPackedGlyph &glyph, std::vector<float> &xy);
+
+// --------------------------------------------------------------------------
+#endif // BEZIER_H
@@ -0,0 +1,211 @@
+// ==========================================================================
+// Batched Bezier Evaluation
+//
+// See BezierBatch.h for an overview of batched Bezier evaluation.
+// ==========================================================================
+
+#include "BezierBatch.h"
+#include "Bezier.h"
+#include <vector>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define BEZIER_BATCH_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define BEZIER_BATCH_SSE
+#endif
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // Bernstein weights of every control point at every grid step, as used
+    // in tessEval.glsl; (Degree + 1) weights per step
+    template <unsigned int Degree>
+    void BernsteinTable(unsigned int steps, vector<float> &weights)
+    {
+        weights.resize((steps + 1) * (Degree + 1));
+        for (unsigned int j = 0; j <= steps; ++j)
+            Bezier<Degree>::Weights(float(j) / steps, &weights[j * (Degree + 1)]);
+    }
+
+    template <unsigned int Degree>
+    void EvaluateScalar(const float *xy, size_t count, unsigned int steps,
+                        const float *weights, float *points)
+    {
+        for (size_t s = 0; s < count; ++s)
+        {
+            const float *p = xy + s * 2 * (Degree + 1);
+            float *out = points + s * 2 * (steps + 1);
+
+            for (unsigned int j = 0; j <= steps; ++j)
+            {
+                const float *w = weights + j * (Degree + 1);
+                float x = 0.f, y = 0.f;
+                for (unsigned int i = 0; i <= Degree; ++i) {
+                    x += w[i] * p[2*i];
+                    y += w[i] * p[2*i + 1];
+                }
+                out[2*j] = x;
+                out[2*j + 1] = y;
+            }
+        }
+    }
+
+#if defined(BEZIER_BATCH_AVX) || defined(BEZIER_BATCH_SSE)
+
+  #if defined(BEZIER_BATCH_AVX)
+    const unsigned int LANES = 8;
+    typedef __m256 Lanes;
+    inline Lanes Load(const float *p)               { return _mm256_loadu_ps(p); }
+    inline Lanes Broadcast(float f)                 { return _mm256_set1_ps(f); }
+    inline Lanes Add(Lanes a, Lanes b)              { return _mm256_add_ps(a, b); }
+    inline Lanes Mul(Lanes a, Lanes b)              { return _mm256_mul_ps(a, b); }
+
+    // writes lane k of x and y as the point for segment k
+    inline void StorePoints(Lanes x, Lanes y, float *const *out)
+    {
+        __m256 lo = _mm256_unpacklo_ps(x, y);  // segments 0 1 | 4 5
+        __m256 hi = _mm256_unpackhi_ps(x, y);  // segments 2 3 | 6 7
+        __m128 lo0 = _mm256_castps256_ps128(lo), lo1 = _mm256_extractf128_ps(lo, 1);
+        __m128 hi0 = _mm256_castps256_ps128(hi), hi1 = _mm256_extractf128_ps(hi, 1);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out[0]), lo0);
+        _mm_storeh_pi(reinterpret_cast<__m64 *>(out[1]), lo0);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out[2]), hi0);
+        _mm_storeh_pi(reinterpret_cast<__m64 *>(out[3]), hi0);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out[4]), lo1);
+        _mm_storeh_pi(reinterpret_cast<__m64 *>(out[5]), lo1);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out[6]), hi1);
+        _mm_storeh_pi(reinterpret_cast<__m64 *>(out[7]), hi1);
+    }
+  #else
+    const unsigned int LANES = 4;
+    typedef __m128 Lanes;
+    inline Lanes Load(const float *p)               { return _mm_loadu_ps(p); }
+    inline Lanes Broadcast(float f)                 { return _mm_set1_ps(f); }
+    inline Lanes Add(Lanes a, Lanes b)              { return _mm_add_ps(a, b); }
+    inline Lanes Mul(Lanes a, Lanes b)              { return _mm_mul_ps(a, b); }
+
+    inline void StorePoints(Lanes x, Lanes y, float *const *out)
+    {
+        __m128 lo = _mm_unpacklo_ps(x, y);     // segments 0 1
+        __m128 hi = _mm_unpackhi_ps(x, y);     // segments 2 3
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out[0]), lo);
+        _mm_storeh_pi(reinterpret_cast<__m64 *>(out[1]), lo);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out[2]), hi);
+        _mm_storeh_pi(reinterpret_cast<__m64 *>(out[3]), hi);
+    }
+  #endif
+
+    // evaluates segments LANES at a time, returning how many were done; the
+    // caller finishes the rest with the scalar path
+    template <unsigned int Degree>
+    size_t EvaluateSimd(const float *xy, size_t count, unsigned int steps,
+                        const float *weights, float *points)
+    {
+        size_t done = 0;
+        for (; done + LANES <= count; done += LANES)
+        {
+            // transpose the control points so that each register holds one
+            // coordinate of one control point for every segment
+            float transposed[2 * (Degree + 1)][LANES];
+            for (unsigned int k = 0; k < LANES; ++k)
+            {
+                const float *p = xy + (done + k) * 2 * (Degree + 1);
+                for (unsigned int i = 0; i < 2 * (Degree + 1); ++i)
+                    transposed[i][k] = p[i];
+            }
+
+            Lanes x[Degree + 1], y[Degree + 1];
+            for (unsigned int i = 0; i <= Degree; ++i) {
+                x[i] = Load(transposed[2*i]);
+                y[i] = Load(transposed[2*i + 1]);
+            }
+
+            float *out[LANES];
+            for (unsigned int k = 0; k < LANES; ++k)
+                out[k] = points + (done + k) * 2 * (steps + 1);
+
+            for (unsigned int j = 0; j <= steps; ++j)
+            {
+                const float *w = weights + j * (Degree + 1);
+                Lanes weight = Broadcast(w[0]);
+                Lanes px = Mul(weight, x[0]);
+                Lanes py = Mul(weight, y[0]);
+                for (unsigned int i = 1; i <= Degree; ++i) {
+                    weight = Broadcast(w[i]);
+                    px = Add(px, Mul(weight, x[i]));
+                    py = Add(py, Mul(weight, y[i]));
+                }
+
+                StorePoints(px, py, out);
+                for (unsigned int k = 0; k < LANES; ++k)
+                    out[k] += 2;
+            }
+        }
+        return done;
+    }
+
+#else
+
+    template <unsigned int Degree>
+    size_t EvaluateSimd(const float *, size_t, unsigned int, const float *, float *)
+    {
+        return 0;
+    }
+
+#endif
+
+    template <unsigned int Degree>
+    void Evaluate(const float *xy, size_t count, unsigned int steps, bool simd, float *points)
+    {
+        vector<float> weights;
+        BernsteinTable<Degree>(steps, weights);
+
+        size_t done = simd ? EvaluateSimd<Degree>(xy, count, steps, &weights[0], points) : 0;
+        EvaluateScalar<Degree>(xy + done * 2 * (Degree + 1), count - done, steps, &weights[0],
+                               points + done * 2 * (steps + 1));
+    }
+
+    void Dispatch(const float *xy, unsigned int degree, size_t count, unsigned int steps,
+                  bool simd, float *points)
+    {
+        if (count == 0 || steps == 0) return;
+
+        switch (degree) {
+        case 1: Evaluate<1>(xy, count, steps, simd, points); break;
+        case 2: Evaluate<2>(xy, count, steps, simd, points); break;
+        case 3: Evaluate<3>(xy, count, steps, simd, points); break;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+const char *BezierBatchPath()
+{
+#if defined(BEZIER_BATCH_AVX)
+    return "AVX";
+#elif defined(BEZIER_BATCH_SSE)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+void EvaluateBezierBatch(const float *xy, unsigned int degree, size_t count,
+                         unsigned int steps, float *points)
+{
+    Dispatch(xy, degree, count, steps, true, points);
+}
+
+void EvaluateBezierBatchScalar(const float *xy, unsigned int degree, size_t count,
+                               unsigned int steps, float *points)
+{
+    Dispatch(xy, degree, count, steps, false, points);
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,38 @@
+// ==========================================================================
+// Batched Bezier Evaluation
+//
+// Evaluates many Bezier segments of one degree at a fixed grid of parameter
+// values, t = 0, 1/steps, 2/steps ... 1, using the same Bernstein form as
+// tessEval.glsl. Segments are processed several at a time, one per lane of
+// a SIMD register:
+//  - 8 segments at once with AVX, when compiled with AVX enabled
+//  - 4 segments at once with SSE2, on any x86-64 compiler
+//  - one at a time with plain floats everywhere else
+// The scalar path is always available, for checking and benchmarking.
+//
+// Control points are read as packed glyphs and patch buffers store them:
+// (degree + 1) consecutive x,y pairs per segment. Results are written as
+// (steps + 1) consecutive x,y pairs per segment, so the output buffer needs
+// room for count * (steps + 1) * 2 floats.
+// ==========================================================================
+#ifndef BEZIERBATCH_H
+#define BEZIERBATCH_H
+
+#include <cstddef>
+
+// --------------------------------------------------------------------------
+
+// name of the instruction set EvaluateBezierBatch uses in this build
+const char *BezierBatchPath();
+
+// evaluates count segments of the given degree (1-3) at steps + 1 points;
+// steps must be at least 1
+void EvaluateBezierBatch(const float *xy, unsigned int degree, size_t count,
+                         unsigned int steps, float *points);
+
+// the same, one segment at a time without SIMD
+void EvaluateBezierBatchScalar(const float *xy, unsigned int degree, size_t count,
+                               unsigned int steps, float *points);
+
+// --------------------------------------------------------------------------
+#endif // BEZIERBATCH_H
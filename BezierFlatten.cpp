@@ -0,0 +1,59 @@
+// ==========================================================================
+// Bezier Curve Flattening
+//
+// See BezierFlatten.h for an overview of curve flattening.
+// ==========================================================================
+
+#include "BezierFlatten.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+size_t FlattenCurve(const float *xy, unsigned int degree, float tolerance,
+                    float *points, size_t capacity)
+{
+    // the degree is chosen once per segment; subdivision is specialized
+    switch (degree) {
+    case 1: return Bezier<1>::Flatten(xy, tolerance, points, capacity);
+    case 2: return Bezier<2>::Flatten(xy, tolerance, points, capacity);
+    case 3: return Bezier<3>::Flatten(xy, tolerance, points, capacity);
+    }
+    return 0;
+}
+
+size_t FlattenSegment(const MySegment &segment, float tolerance,
+                      float *points, size_t capacity)
+{
+    float xy[8];
+    for (unsigned int i = 0; i <= segment.degree && i < 4; ++i)
+    {
+        xy[2*i]     = segment.x[i];
+        xy[2*i + 1] = segment.y[i];
+    }
+    return FlattenCurve(xy, segment.degree, tolerance, points, capacity);
+}
+
+size_t FlattenContour(const MyContour &contour, float tolerance,
+                      float *points, size_t capacity)
+{
+    if (contour.empty()) return 0;
+
+    size_t count = 1;
+    if (capacity > 0) {
+        points[0] = contour[0].x[0];
+        points[1] = contour[0].y[0];
+    }
+
+    for (size_t i = 0; i < contour.size(); ++i)
+    {
+        // once the buffer is full, keep counting without writing
+        size_t room = count < capacity ? capacity - count : 0;
+        float *next = room > 0 ? points + 2*count : points;
+        count += FlattenSegment(contour[i], tolerance, next, room);
+    }
+
+    return count;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,54 @@
+// ==========================================================================
+// Bezier Curve Flattening
+//
+// Converts line, quadratic and cubic Bezier segments into polylines on the
+// CPU, for uses that cannot go through the tessellation shaders: exporting
+// outlines, hit-testing and software rendering.
+//  - Curves are split in half by de Casteljau subdivision until each piece
+//    is flat enough to be drawn as a single straight step
+//  - A piece is flat when all of its inner control points lie within the
+//    tolerance of the chord between its end points. The piece lies inside
+//    the convex hull of its control points, so it then lies within the
+//    tolerance of the chord too, and the polyline never strays further
+//  - Subdivision uses a fixed-size stack and writes into buffers supplied by
+//    the caller, so flattening allocates no memory
+//
+// Polylines are written as x,y pairs. The first point of a segment is not
+// written, so that the polylines of consecutive segments of a contour join
+// up without repeated points.
+// ==========================================================================
+#ifndef BEZIERFLATTEN_H
+#define BEZIERFLATTEN_H
+
+#include <cstddef>
+
+#include "Bezier.h"
+#include "GlyphExtractor.h"
+
+// --------------------------------------------------------------------------
+
+// deepest subdivision allowed; each level cuts the distance between a
+// curve and its chord by about a factor of four, so this limit is only
+// reached for tolerances below a billionth of the size of the curve, and
+// it bounds the length of one segment's polyline to 2^16 points
+const int       FLATTEN_MAX_DEPTH   = BEZIER_MAX_DEPTH;
+const size_t    FLATTEN_MAX_POINTS  = size_t(1) << FLATTEN_MAX_DEPTH;
+
+// Flattens one segment given as (degree + 1) x,y control points, writing at
+// most capacity points. Returns the number of points in the full polyline,
+// which is more than capacity if the buffer was too small. Points
+// (degree 0) produce no polyline.
+size_t FlattenCurve(const float *xy, unsigned int degree, float tolerance,
+                    float *points, size_t capacity);
+
+// the same for a MySegment
+size_t FlattenSegment(const MySegment &segment, float tolerance,
+                      float *points, size_t capacity);
+
+// Flattens a whole contour into one closed polyline, starting with the first
+// point of the first segment; returns the number of points as above
+size_t FlattenContour(const MyContour &contour, float tolerance,
+                      float *points, size_t capacity);
+
+// --------------------------------------------------------------------------
+#endif // BEZIERFLATTEN_H
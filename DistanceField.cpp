@@ -0,0 +1,778 @@
+// ==========================================================================
+// Signed Distance Fields
+//
+// See DistanceField.h for an overview of distance field generation. The
+// edge colouring, pseudo-distances and clash correction of multi-channel
+// fields follow Viktor Chlumsky's msdfgen.
+// ==========================================================================
+
+#include "DistanceField.h"
+#include "Bezier.h"
+#include "BezierFlatten.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // width and height of a grid cell, in pixels
+    const int CELL = 8;
+
+    // how far, in pixels, the outline used to find the winding number may
+    // stray from the true one
+    const float WINDING_TOLERANCE = 0.01f;
+
+    // edge colours of multi-channel fields, as masks of the channels an
+    // edge takes part in
+    enum EdgeColour
+    {
+        RED = 1, GREEN = 2, BLUE = 4,
+        YELLOW = RED | GREEN, MAGENTA = RED | BLUE, CYAN = GREEN | BLUE,
+        WHITE = RED | GREEN | BLUE
+    };
+
+    // msdfgen's angle threshold, in radians. Contours turn a corner where
+    // the directions on either side turn by more than pi minus this, about
+    // 0.14 radians or 8 degrees, since the sine of the turn is compared with
+    // the sine of the threshold
+    const float ANGLE_THRESHOLD = 3.f;
+
+    // length, in pixels, below which the curves between two corners are
+    // coloured as part of a single corner
+    const float MINOR_SPLINE = 1.f;
+
+    struct Curve
+    {
+        unsigned int    degree;
+        unsigned int    colour;
+        float           xy[8];
+        float           lower[2], upper[2];
+    };
+
+    // the nearest curve to a pixel found so far for one channel
+    struct Nearest
+    {
+        float           distance2;
+        float           orthogonality;
+        const Curve    *curve;
+        float           t;
+    };
+
+    // Holds a glyph's segments in image coordinates, with y downwards and
+    // the origin at the image's top left corner, and the grid over them.
+    // Rows can be generated in any order and from any thread.
+    class FieldBuilder
+    {
+        DistanceField          &m_field;
+        vector<Curve>           m_curves;
+
+        // x0,y0,x1,y1 of every edge of the flattened outline
+        vector<float>           m_edges;
+
+        // the curves of each cell are m_cellCurves[m_cellStart[i]] up to
+        // m_cellCurves[m_cellStart[i + 1]]
+        int                     m_cellsX, m_cellsY;
+        vector<unsigned int>    m_cellStart;
+        vector<unsigned int>    m_cellCurves;
+
+        // multi-channel fields: the signed area of the outline, +1 or -1 to
+        // make the filled side of a curve positive, and signed distances
+        // over range for every channel, before clash correction
+        float                   m_area;
+        float                   m_orientation;
+        vector<float>           m_distances;
+
+        void AddEdges(const float *points, size_t count, float size);
+        void BuildGrid();
+        void Crossings(float y, vector<pair<float, int> > &crossings) const;
+        float ChannelDistance(const Nearest &nearest, const float *point) const;
+
+    public:
+        FieldBuilder(const MyGlyph &glyph, float size, float range, int channels,
+                     DistanceField &field);
+
+        void Row(int row);
+
+        // turns the distances of a multi-channel field into pixels
+        void Finish();
+    };
+
+    // ----------------------------------------------------------------------
+
+    float CurveDistance2(const Curve &curve, const float *point, float *t = 0)
+    {
+        switch (curve.degree)
+        {
+        case 1:     return Bezier<1>::Distance2(curve.xy, point, t);
+        case 2:     return Bezier<2>::Distance2(curve.xy, point, t);
+        default:    return Bezier<3>::Distance2(curve.xy, point, t);
+        }
+    }
+
+    void CurveBounds(Curve &curve)
+    {
+        switch (curve.degree)
+        {
+        case 1:     Bezier<1>::Bounds(curve.xy, curve.lower, curve.upper); break;
+        case 2:     Bezier<2>::Bounds(curve.xy, curve.lower, curve.upper); break;
+        default:    Bezier<3>::Bounds(curve.xy, curve.lower, curve.upper); break;
+        }
+    }
+
+    void CurvePoint(const Curve &curve, float t, float *point)
+    {
+        switch (curve.degree)
+        {
+        case 1:     Bezier<1>::Evaluate(curve.xy, t, point); break;
+        case 2:     Bezier<2>::Evaluate(curve.xy, t, point); break;
+        default:    Bezier<3>::Evaluate(curve.xy, t, point); break;
+        }
+    }
+
+    void SplitCurve(const Curve &curve, float t, Curve &left, Curve &right)
+    {
+        left = right = curve;
+        switch (curve.degree)
+        {
+        case 1:     Bezier<1>::Split(curve.xy, t, left.xy, right.xy); break;
+        case 2:     Bezier<2>::Split(curve.xy, t, left.xy, right.xy); break;
+        default:    Bezier<3>::Split(curve.xy, t, left.xy, right.xy); break;
+        }
+    }
+
+    // direction of a curve at t, which is not normalized. At the end points
+    // it comes from the nearest control point that differs from the end, so
+    // that curves with doubled control points still have a direction.
+    void CurveDirection(const Curve &curve, float t, float *direction)
+    {
+        const float *xy = curve.xy;
+        unsigned int degree = curve.degree;
+
+        if (t <= 0.f || t >= 1.f)
+        {
+            const float *end = t <= 0.f ? xy : xy + 2*degree;
+            for (unsigned int i = 1; i <= degree; ++i)
+            {
+                const float *other = t <= 0.f ? xy + 2*i : xy + 2*(degree - i);
+                direction[0] = t <= 0.f ? other[0] - end[0] : end[0] - other[0];
+                direction[1] = t <= 0.f ? other[1] - end[1] : end[1] - other[1];
+                if (direction[0] != 0.f || direction[1] != 0.f) return;
+            }
+            return;
+        }
+
+        // the derivative, by de Casteljau on the differences
+        float work[6];
+        for (unsigned int i = 0; i < degree; ++i) {
+            work[2*i] = xy[2*i + 2] - xy[2*i];
+            work[2*i + 1] = xy[2*i + 3] - xy[2*i + 1];
+        }
+        for (unsigned int level = 1; level < degree; ++level)
+        {
+            for (unsigned int i = 0; i + level < degree; ++i) {
+                work[2*i] += t * (work[2*i + 2] - work[2*i]);
+                work[2*i + 1] += t * (work[2*i + 3] - work[2*i + 1]);
+            }
+        }
+        direction[0] = work[0];
+        direction[1] = work[1];
+    }
+
+    // how far from right angles a point lies to the curve at t, as the
+    // cosine of the angle; zero away from the end points, where the nearest
+    // point is always at right angles
+    float Orthogonality(const Curve &curve, float t, const float *point)
+    {
+        if (t > 0.f && t < 1.f) return 0.f;
+
+        float b[2], direction[2];
+        CurvePoint(curve, t, b);
+        CurveDirection(curve, t, direction);
+        float vx = point[0] - b[0], vy = point[1] - b[1];
+        float lengths = sqrt((vx*vx + vy*vy) * (direction[0]*direction[0] + direction[1]*direction[1]));
+        return lengths > 0.f ? fabs(vx*direction[0] + vy*direction[1]) / lengths : 0.f;
+    }
+
+    // ----------------------------------------------------------------------
+    // Edge colouring, which gives the curves on either side of every corner
+    // different colours, so that the median of the channels keeps the
+    // corner sharp
+
+    bool IsCorner(const float *before, const float *after)
+    {
+        float lengths = sqrt((before[0]*before[0] + before[1]*before[1])
+                             * (after[0]*after[0] + after[1]*after[1]));
+        if (lengths == 0.f) return false;
+
+        float dot = (before[0]*after[0] + before[1]*after[1]) / lengths;
+        float cross = (before[0]*after[1] - before[1]*after[0]) / lengths;
+        return dot <= 0.f || fabs(cross) > sin(ANGLE_THRESHOLD);
+    }
+
+    // moves to the next of the two-channel colours, avoiding any colour
+    // that shares only one channel with banned
+    void SwitchColour(unsigned int &colour, unsigned int banned = 0)
+    {
+        unsigned int shared = colour & banned;
+        if (shared == RED || shared == GREEN || shared == BLUE) {
+            colour = shared ^ WHITE;
+            return;
+        }
+        if (colour == WHITE || colour == 0) {
+            colour = CYAN;
+            return;
+        }
+        unsigned int shifted = colour << 1;
+        colour = (shifted | shifted >> 3) & WHITE;
+    }
+
+    // spreads position in [0, count) over -1, 0 and 1, symmetrically
+    int Trichotomy(size_t position, size_t count)
+    {
+        return int(3.f + 2.875f * position / (count - 1) - 1.4375f + 0.5f) - 3;
+    }
+
+    void ColourContour(vector<Curve> &curves)
+    {
+        if (curves.empty()) return;
+
+        vector<size_t> corners;
+        for (size_t i = 0; i < curves.size(); ++i)
+        {
+            float before[2], after[2];
+            CurveDirection(curves[(i + curves.size() - 1) % curves.size()], 1.f, before);
+            CurveDirection(curves[i], 0.f, after);
+            if (IsCorner(before, after)) corners.push_back(i);
+        }
+
+        if (corners.empty())
+        {
+            // smooth all round
+            for (size_t i = 0; i < curves.size(); ++i)
+                curves[i].colour = WHITE;
+        }
+        else if (corners.size() == 1)
+        {
+            // a teardrop needs three colours around it, so split short
+            // contours into enough pieces to take them
+            if (curves.size() < 3)
+            {
+                vector<Curve> pieces;
+                for (size_t i = 0; i < curves.size(); ++i)
+                {
+                    Curve first, rest, second, third;
+                    SplitCurve(curves[(corners[0] + i) % curves.size()], 1.f / 3, first, rest);
+                    SplitCurve(rest, 0.5f, second, third);
+                    pieces.push_back(first);
+                    pieces.push_back(second);
+                    pieces.push_back(third);
+                }
+                curves.swap(pieces);
+                corners[0] = 0;
+            }
+
+            unsigned int colours[3] = { WHITE, WHITE, WHITE };
+            SwitchColour(colours[0]);
+            colours[2] = colours[0];
+            SwitchColour(colours[2]);
+
+            size_t count = curves.size();
+            for (size_t i = 0; i < count; ++i)
+                curves[(corners[0] + i) % count].colour = colours[1 + Trichotomy(i, count)];
+        }
+        else
+        {
+            // The curves between two corners form a spline. Splines shorter
+            // than MINOR_SPLINE are usually a flattened tip between two
+            // corners that meet at this size, so the splines either side of
+            // them must differ as if they met at one corner.
+            size_t count = curves.size();
+            size_t splines = corners.size();
+            vector<bool> major(splines);
+            size_t majors = 0;
+            for (size_t k = 0; k < splines; ++k)
+            {
+                size_t end = k + 1 < splines ? corners[k + 1] : corners[0] + count;
+                float length = 0.f;
+                for (size_t i = corners[k]; i < end; ++i)
+                {
+                    const Curve &curve = curves[i % count];
+                    const float *last = curve.xy + 2*curve.degree;
+                    length += hypot(last[0] - curve.xy[0], last[1] - curve.xy[1]);
+                }
+                major[k] = length >= MINOR_SPLINE;
+                if (major[k]) ++majors;
+            }
+            if (majors < 2) {
+                major.assign(splines, true);
+                majors = splines;
+            }
+
+            // change colour at every major spline; the last must also differ
+            // from the first
+            vector<unsigned int> colours(splines, 0);
+            unsigned int colour = WHITE;
+            size_t seen = 0;
+            unsigned int first = 0;
+            for (size_t k = 0; k < splines; ++k)
+            {
+                if (!major[k]) continue;
+                SwitchColour(colour, ++seen == majors ? first : 0);
+                if (seen == 1) first = colour;
+                colours[k] = colour;
+            }
+
+            // minor splines take the colour that differs from both of their
+            // neighbours
+            for (size_t k = 0; k < splines; ++k)
+            {
+                if (major[k]) continue;
+                size_t before = k, after = k;
+                do before = (before + splines - 1) % splines; while (!major[before]);
+                do after = (after + 1) % splines; while (!major[after]);
+                colours[k] = WHITE ^ (colours[before] & colours[after]);
+            }
+
+            for (size_t k = 0; k < splines; ++k)
+            {
+                size_t end = k + 1 < splines ? corners[k + 1] : corners[0] + count;
+                for (size_t i = corners[k]; i < end; ++i)
+                    curves[i % count].colour = colours[k];
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------------
+
+    float Median(float a, float b, float c)
+    {
+        return max(min(a, b), min(max(a, b), c));
+    }
+
+    // whether interpolating between neighbouring pixels a and b would make
+    // a false edge, and a is the one of the two further from the outline
+    bool Clashes(const float *a, const float *b, float threshold)
+    {
+        // order the channels by how much they change, most first
+        float a0 = a[0], a1 = a[1], a2 = a[2];
+        float b0 = b[0], b1 = b[1], b2 = b[2];
+        if (fabs(b1 - a1) < fabs(b0 - a0)) {
+            swap(a0, a1);
+            swap(b0, b1);
+        }
+        if (fabs(b2 - a2) < fabs(b1 - a1))
+        {
+            swap(a1, a2);
+            swap(b1, b2);
+            if (fabs(b1 - a1) < fabs(b0 - a0)) {
+                swap(a0, a1);
+                swap(b0, b1);
+            }
+        }
+        return fabs(b1 - a1) >= threshold
+            && !(b0 == b1 && b0 == b2)
+            && fabs(a2) >= fabs(b2);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+FieldBuilder::FieldBuilder(const MyGlyph &glyph, float size, float range, int channels,
+                           DistanceField &field)
+    : m_field(field), m_cellsX(0), m_cellsY(0), m_area(0.f), m_orientation(1.f)
+{
+    field.width = field.height = 0;
+    field.left = field.top = 0;
+    field.channels = channels;
+    field.size = size;
+    field.range = range;
+    field.pixels.clear();
+
+    // segments scaled to pixels, still with y upwards, coloured one
+    // contour at a time
+    float lower[2] = { 0.f, 0.f }, upper[2] = { 0.f, 0.f };
+    vector<Curve> contourCurves;
+    for (size_t c = 0; c < glyph.contours.size(); ++c)
+    {
+        const MyContour &contour = glyph.contours[c];
+        contourCurves.clear();
+
+        for (size_t s = 0; s < contour.size(); ++s)
+        {
+            const MySegment &segment = contour[s];
+            if (segment.degree < 1 || segment.degree > 3) continue;
+
+            Curve curve;
+            curve.degree = segment.degree;
+            curve.colour = WHITE;
+            for (unsigned int i = 0; i <= segment.degree; ++i)
+            {
+                float x = size * segment.x[i];
+                float y = size * segment.y[i];
+                curve.xy[2*i] = x;
+                curve.xy[2*i + 1] = y;
+
+                // control points bound the curve
+                if (m_curves.empty() && contourCurves.empty() && i == 0) {
+                    lower[0] = upper[0] = x;
+                    lower[1] = upper[1] = y;
+                }
+                lower[0] = min(lower[0], x);
+                lower[1] = min(lower[1], y);
+                upper[0] = max(upper[0], x);
+                upper[1] = max(upper[1], y);
+            }
+            contourCurves.push_back(curve);
+        }
+
+        if (channels == 3) ColourContour(contourCurves);
+        m_curves.insert(m_curves.end(), contourCurves.begin(), contourCurves.end());
+    }
+    if (m_curves.empty()) return;
+
+    int left = int(floor(lower[0] - range));
+    int right = int(ceil(upper[0] + range));
+    int bottom = int(floor(lower[1] - range));
+    int top = int(ceil(upper[1] + range));
+    field.left = left;
+    field.top = top;
+    field.width = right - left;
+    field.height = top - bottom;
+    field.pixels.resize(size_t(field.width) * field.height * channels);
+    if (channels == 3) m_distances.resize(field.pixels.size());
+
+    // move to image coordinates
+    for (size_t i = 0; i < m_curves.size(); ++i)
+    {
+        Curve &curve = m_curves[i];
+        for (unsigned int p = 0; p <= curve.degree; ++p) {
+            curve.xy[2*p] -= left;
+            curve.xy[2*p + 1] = top - curve.xy[2*p + 1];
+        }
+        CurveBounds(curve);
+    }
+
+    vector<float> points(2 * 1024);
+    float tolerance = size > 0.f ? WINDING_TOLERANCE / size : WINDING_TOLERANCE;
+    for (size_t c = 0; c < glyph.contours.size(); ++c)
+    {
+        const MyContour &contour = glyph.contours[c];
+
+        size_t count = FlattenContour(contour, tolerance, &points[0], points.size() / 2);
+        if (count > points.size() / 2) {
+            points.resize(2 * count);
+            count = FlattenContour(contour, tolerance, &points[0], count);
+        }
+        AddEdges(&points[0], count, size);
+    }
+
+    // which side of the curves is filled follows from which way the
+    // outline turns overall
+    m_orientation = m_area < 0.f ? -1.f : 1.f;
+
+    BuildGrid();
+}
+
+void FieldBuilder::AddEdges(const float *points, size_t count, float size)
+{
+    if (count < 2) return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        // the last edge closes the contour
+        const float *a = points + 2*i;
+        const float *b = points + 2*((i + 1) % count);
+
+        float y0 = m_field.top - size * a[1];
+        float y1 = m_field.top - size * b[1];
+        m_area += 0.5f * size * (a[0]*y1 - b[0]*y0);
+        if (y0 == y1) continue;
+
+        m_edges.push_back(size * a[0] - m_field.left);
+        m_edges.push_back(y0);
+        m_edges.push_back(size * b[0] - m_field.left);
+        m_edges.push_back(y1);
+    }
+}
+
+void FieldBuilder::BuildGrid()
+{
+    m_cellsX = (m_field.width + CELL - 1) / CELL;
+    m_cellsY = (m_field.height + CELL - 1) / CELL;
+    m_cellStart.assign(size_t(m_cellsX) * m_cellsY + 1, 0);
+
+    // every curve goes into each cell its bounds come within range of;
+    // count them, then fill them in
+    vector<int> span(4 * m_curves.size());
+    for (size_t i = 0; i < m_curves.size(); ++i)
+    {
+        const Curve &curve = m_curves[i];
+        int *s = &span[4 * i];
+        s[0] = max(int(floor((curve.lower[0] - m_field.range) / CELL)), 0);
+        s[1] = min(int(floor((curve.upper[0] + m_field.range) / CELL)), m_cellsX - 1);
+        s[2] = max(int(floor((curve.lower[1] - m_field.range) / CELL)), 0);
+        s[3] = min(int(floor((curve.upper[1] + m_field.range) / CELL)), m_cellsY - 1);
+
+        for (int y = s[2]; y <= s[3]; ++y)
+            for (int x = s[0]; x <= s[1]; ++x)
+                ++m_cellStart[size_t(y) * m_cellsX + x + 1];
+    }
+
+    for (size_t i = 1; i < m_cellStart.size(); ++i)
+        m_cellStart[i] += m_cellStart[i - 1];
+    m_cellCurves.resize(m_cellStart.back());
+
+    vector<unsigned int> next(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t i = 0; i < m_curves.size(); ++i)
+    {
+        const int *s = &span[4 * i];
+        for (int y = s[2]; y <= s[3]; ++y)
+            for (int x = s[0]; x <= s[1]; ++x)
+                m_cellCurves[next[size_t(y) * m_cellsX + x]++] = unsigned(i);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void FieldBuilder::Crossings(float y, vector<pair<float, int> > &crossings) const
+{
+    // where the outline crosses the line at y, and which way, from left to
+    // right
+    crossings.clear();
+    for (size_t e = 0; e < m_edges.size(); e += 4)
+    {
+        const float *edge = &m_edges[e];
+        if ((edge[1] <= y) == (edge[3] <= y)) continue;
+
+        float x = edge[0] + (y - edge[1]) * (edge[2] - edge[0]) / (edge[3] - edge[1]);
+        crossings.push_back(make_pair(x, edge[3] > edge[1] ? 1 : -1));
+    }
+    sort(crossings.begin(), crossings.end());
+}
+
+float FieldBuilder::ChannelDistance(const Nearest &nearest, const float *point) const
+{
+    // signed by the side of the curve the point is on
+    float b[2], direction[2];
+    CurvePoint(*nearest.curve, nearest.t, b);
+    CurveDirection(*nearest.curve, nearest.t, direction);
+    float vx = point[0] - b[0];
+    float vy = point[1] - b[1];
+    float cross = direction[0]*vy - direction[1]*vx;
+    float distance = sqrt(nearest.distance2);
+    float sign = cross * m_orientation >= 0.f ? 1.f : -1.f;
+
+    // Beyond either end of the curve, use the distance to its tangent
+    // there instead. Inside the shape's corners this keeps both sides of
+    // the corner straight out to the range of the field.
+    float along = direction[0]*vx + direction[1]*vy;
+    if ((nearest.t <= 0.f && along < 0.f) || (nearest.t >= 1.f && along > 0.f))
+    {
+        float length = sqrt(direction[0]*direction[0] + direction[1]*direction[1]);
+        if (length > 0.f)
+        {
+            float pseudo = cross / length;
+            if (fabs(pseudo) <= distance)
+                return pseudo * m_orientation;
+        }
+    }
+    return sign * distance;
+}
+
+void FieldBuilder::Row(int row)
+{
+    float point[2];
+    point[1] = row + 0.5f;
+
+    vector<pair<float, int> > crossings;
+    Crossings(point[1], crossings);
+
+    float range = m_field.range;
+    float range2 = range * range;
+    const unsigned int *cells = &m_cellStart[size_t(row / CELL) * m_cellsX];
+
+    size_t crossing = 0;
+    int winding = 0;
+    for (int column = 0; column < m_field.width; ++column)
+    {
+        point[0] = column + 0.5f;
+        for (; crossing < crossings.size() && crossings[crossing].first < point[0]; ++crossing)
+            winding += crossings[crossing].second;
+
+        int cell = column / CELL;
+        size_t pixel = size_t(row) * m_field.width + column;
+
+        if (m_field.channels == 1)
+        {
+            // nearest curve of the cell, skipping curves whose bounds are
+            // further away than the best so far
+            float best = range2;
+            for (unsigned int i = cells[cell]; i < cells[cell + 1]; ++i)
+            {
+                const Curve &curve = m_curves[m_cellCurves[i]];
+                float dx = max(max(curve.lower[0] - point[0], point[0] - curve.upper[0]), 0.f);
+                float dy = max(max(curve.lower[1] - point[1], point[1] - curve.upper[1]), 0.f);
+                if (dx*dx + dy*dy >= best) continue;
+
+                best = min(best, CurveDistance2(curve, point));
+            }
+
+            float distance = sqrt(best) / range;
+            if (winding == 0) distance = -distance;
+            m_field.pixels[pixel] = (unsigned char)(127.5f + 127.5f * distance + 0.5f);
+            continue;
+        }
+
+        // Nearest curve of each colour channel. Where curves meet, they are
+        // equally near; the one whose direction is more nearly at right
+        // angles to the pixel wins.
+        Nearest nearest[3];
+        for (int channel = 0; channel < 3; ++channel) {
+            nearest[channel].distance2 = range2;
+            nearest[channel].curve = 0;
+        }
+
+        for (unsigned int i = cells[cell]; i < cells[cell + 1]; ++i)
+        {
+            const Curve &curve = m_curves[m_cellCurves[i]];
+            float dx = max(max(curve.lower[0] - point[0], point[0] - curve.upper[0]), 0.f);
+            float dy = max(max(curve.lower[1] - point[1], point[1] - curve.upper[1]), 0.f);
+            float box2 = dx*dx + dy*dy;
+
+            bool closer = false;
+            for (int channel = 0; channel < 3; ++channel)
+                if ((curve.colour & (1 << channel)) && box2 <= nearest[channel].distance2)
+                    closer = true;
+            if (!closer) continue;
+
+            float t;
+            float distance2 = CurveDistance2(curve, point, &t);
+            float orthogonality = -1.f;
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                Nearest &best = nearest[channel];
+                if (!(curve.colour & (1 << channel)) || distance2 > best.distance2) continue;
+
+                if (orthogonality < 0.f) orthogonality = Orthogonality(curve, t, point);
+                if (distance2 == best.distance2 && best.curve && orthogonality >= best.orthogonality)
+                    continue;
+
+                best.distance2 = distance2;
+                best.orthogonality = orthogonality;
+                best.curve = &curve;
+                best.t = t;
+            }
+        }
+
+        // channels with no curve in range are as far as the range allows,
+        // on the side the winding number says
+        float inside = winding != 0 ? 1.f : -1.f;
+        float distances[3];
+        for (int channel = 0; channel < 3; ++channel)
+            distances[channel] = nearest[channel].curve
+                ? ChannelDistance(nearest[channel], point) / range : inside;
+
+        // where the curves' sides disagree with the winding number, as
+        // with contours turning the other way, trust the winding number
+        if ((Median(distances[0], distances[1], distances[2]) > 0.f) != (winding != 0))
+        {
+            for (int channel = 0; channel < 3; ++channel)
+                if (nearest[channel].curve) distances[channel] = -distances[channel];
+        }
+
+        float *out = &m_distances[3 * pixel];
+        for (int channel = 0; channel < 3; ++channel)
+            out[channel] = min(max(distances[channel], -1.f), 1.f);
+    }
+}
+
+
+void FieldBuilder::Finish()
+{
+    if (m_field.channels != 3 || m_distances.empty()) return;
+
+    int width = m_field.width, height = m_field.height;
+
+    // a clash is a pair of neighbours between which two channels change by
+    // more than they could across one pixel of real outline; the pixel of
+    // the pair further from the outline gets the median in every channel
+    float threshold = 1.001f / m_field.range;
+    vector<bool> clashes(size_t(width) * height, false);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float *a = &m_distances[3 * (size_t(y) * width + x)];
+            if ((x > 0 && Clashes(a, a - 3, threshold))
+                || (x + 1 < width && Clashes(a, a + 3, threshold))
+                || (y > 0 && Clashes(a, a - 3*width, threshold))
+                || (y + 1 < height && Clashes(a, a + 3*width, threshold)))
+                clashes[size_t(y) * width + x] = true;
+        }
+    }
+
+    for (size_t i = 0; i < clashes.size(); ++i)
+    {
+        float *d = &m_distances[3 * i];
+        if (clashes[i]) d[0] = d[1] = d[2] = Median(d[0], d[1], d[2]);
+        for (int channel = 0; channel < 3; ++channel)
+            m_field.pixels[3*i + channel] = (unsigned char)(127.5f + 127.5f * d[channel] + 0.5f);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    void Generate(const MyGlyph &glyph, float size, float range, int channels,
+                  DistanceField &field, ThreadPool &pool)
+    {
+        FieldBuilder builder(glyph, size, range, channels, field);
+        pool.ParallelFor(size_t(field.height), [&](size_t row, unsigned int) {
+            builder.Row(int(row));
+        }, 4);
+        builder.Finish();
+    }
+
+    void GenerateAll(const vector<MyGlyph> &glyphs, float size, float range, int channels,
+                     vector<DistanceField> &fields, ThreadPool &pool)
+    {
+        fields.resize(glyphs.size());
+        pool.ParallelFor(glyphs.size(), [&](size_t index, unsigned int) {
+            FieldBuilder builder(glyphs[index], size, range, channels, fields[index]);
+            for (int row = 0; row < fields[index].height; ++row)
+                builder.Row(row);
+            builder.Finish();
+        });
+    }
+}
+
+void GenerateDistanceField(const MyGlyph &glyph, float size, float range,
+                           DistanceField &field, ThreadPool &pool)
+{
+    Generate(glyph, size, range, 1, field, pool);
+}
+
+void GenerateDistanceFields(const vector<MyGlyph> &glyphs, float size, float range,
+                            vector<DistanceField> &fields, ThreadPool &pool)
+{
+    GenerateAll(glyphs, size, range, 1, fields, pool);
+}
+
+void GenerateMultiChannelField(const MyGlyph &glyph, float size, float range,
+                               DistanceField &field, ThreadPool &pool)
+{
+    Generate(glyph, size, range, 3, field, pool);
+}
+
+void GenerateMultiChannelFields(const vector<MyGlyph> &glyphs, float size, float range,
+                                vector<DistanceField> &fields, ThreadPool &pool)
+{
+    GenerateAll(glyphs, size, range, 3, fields, pool);
+}
+
+// --------------------------------------------------------------------------
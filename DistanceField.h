@@ -0,0 +1,87 @@
+// ==========================================================================
+// Signed Distance Fields
+//
+// Generates signed distance field images of glyphs straight from the Bezier
+// segments of their outlines, for text that stays sharp when scaled:
+//  - each pixel holds the distance from its centre to the nearest point of
+//    the outline (see Bezier::Distance2), positive inside the glyph
+//  - distances are clamped to the field's range, so a pixel only needs the
+//    segments that come within range of it. Segments are entered into a
+//    grid of square cells, each listing the segments whose bounds pass
+//    within range of the cell, and a pixel measures only the segments of
+//    its own cell, skipping those whose bounds are already further away
+//    than the nearest point found so far
+//  - inside and outside come from the nonzero winding number: each row
+//    finds where a finely flattened outline crosses its centre line
+//  - rows of one field, or whole glyphs when generating many at once, are
+//    spread over the shared ThreadPool
+// Fields are stored top row first, with the outline at 127.5, range pixels
+// inside at 255 and range pixels outside at 0.
+//
+// Multi-channel fields keep corners sharp when magnified, where a single
+// distance rounds them off. Their segments are coloured red, green and blue
+// so that the two sides of every corner share only one channel. Each
+// channel holds the distance to the nearest segment of that colour,
+// measured to the segment's tangent line beyond its end points, and the
+// median of the three channels reproduces the outline with its corners.
+// Neighbouring pixels whose channels would interpolate into a false edge
+// are given the median in all three channels.
+// ==========================================================================
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <vector>
+
+#include "GlyphExtractor.h"
+#include "ThreadPool.h"
+
+// --------------------------------------------------------------------------
+
+// default distance, in pixels, covered by the values 0 to 255
+const float DEFAULT_DISTANCE_RANGE = 4.f;
+
+struct DistanceField
+{
+    // image size; both are zero for glyphs with no outline
+    int             width, height;
+
+    // 1 for a signed distance field, 3 for a multi-channel field with the
+    // channels of each pixel stored together as RGB
+    int             channels;
+
+    // pixel position of the image's top left corner relative to the glyph
+    // origin, with y upwards as in EM units
+    int             left, top;
+
+    // pixels per EM, and the distance in pixels mapped to 0 and 255
+    float           size;
+    float           range;
+
+    std::vector<unsigned char> pixels;
+
+    DistanceField()
+        : width(0), height(0), channels(1), left(0), top(0), size(0.f), range(0.f)
+    {}
+};
+
+// Generates the field of a glyph at size pixels per EM, leaving range
+// pixels of space around the outline, with its rows split across the pool
+void GenerateDistanceField(const MyGlyph &glyph, float size, float range,
+                           DistanceField &field,
+                           ThreadPool &pool = ThreadPool::Shared());
+
+// the same for many glyphs, one glyph per task
+void GenerateDistanceFields(const std::vector<MyGlyph> &glyphs, float size,
+                            float range, std::vector<DistanceField> &fields,
+                            ThreadPool &pool = ThreadPool::Shared());
+
+// the same as the two above, for multi-channel fields
+void GenerateMultiChannelField(const MyGlyph &glyph, float size, float range,
+                               DistanceField &field,
+                               ThreadPool &pool = ThreadPool::Shared());
+void GenerateMultiChannelFields(const std::vector<MyGlyph> &glyphs, float size,
+                                float range, std::vector<DistanceField> &fields,
+                                ThreadPool &pool = ThreadPool::Shared());
+
+// --------------------------------------------------------------------------
+#endif // DISTANCEFIELD_H
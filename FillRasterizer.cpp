@@ -0,0 +1,324 @@
+// ==========================================================================
+// Filled Glyph Rasterizer
+//
+// See FillRasterizer.h for an overview of the fill rasterizer. The area
+// accumulation follows Raph Levien's font-rs, which in turn follows
+// stb_truetype's second rasterizer.
+// ==========================================================================
+
+#include "FillRasterizer.h"
+#include "BezierFlatten.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+const int FillRasterizer::TILE;
+
+FillRasterizer::FillRasterizer(int width, int height, float tolerance, ThreadPool &pool)
+    : m_width(max(width, 1)), m_height(max(height, 1)),
+      m_tilesX((m_width + TILE - 1) / TILE), m_tilesY((m_height + TILE - 1) / TILE),
+      m_tolerance(tolerance), m_pool(pool),
+      m_bins(size_t(m_tilesX) * m_tilesY),
+      m_carry(size_t(m_tilesX) * m_tilesY * TILE),
+      m_polyline(2 * 1024),
+      m_accumulation(pool.Size())
+{}
+
+void FillRasterizer::Clear()
+{
+    m_edges.clear();
+}
+
+void FillRasterizer::AddEdge(float x0, float y0, float x1, float y1)
+{
+    // horizontal edges cover nothing
+    if (y0 == y1) return;
+
+    Edge edge = { x0, y0, x1, y1 };
+    m_edges.push_back(edge);
+}
+
+void FillRasterizer::AddGlyph(const MyGlyph &glyph, float size, float x, float y)
+{
+    float tolerance = size > 0.f ? m_tolerance / size : m_tolerance;
+
+    for (size_t c = 0; c < glyph.contours.size(); ++c)
+    {
+        const MyContour &contour = glyph.contours[c];
+
+        // grow the buffer until the whole contour fits
+        size_t count = FlattenContour(contour, tolerance, &m_polyline[0], m_polyline.size() / 2);
+        if (count > m_polyline.size() / 2) {
+            m_polyline.resize(2 * count);
+            count = FlattenContour(contour, tolerance, &m_polyline[0], count);
+        }
+        if (count < 2) continue;
+
+        // EM units have y upwards; pixels have it downwards
+        const float *p = &m_polyline[0];
+        for (size_t i = 0; i + 1 < count; ++i)
+            AddEdge(x + size * p[2*i], y - size * p[2*i + 1],
+                    x + size * p[2*i + 2], y - size * p[2*i + 3]);
+
+        // make sure the contour is closed
+        const float *last = p + 2*(count - 1);
+        if (last[0] != p[0] || last[1] != p[1])
+            AddEdge(x + size * last[0], y - size * last[1], x + size * p[0], y - size * p[1]);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void FillRasterizer::AddPiece(const Edge &piece)
+{
+    // a piece lies within one tile; its midpoint says which. Pieces on the
+    // right edge of the image have no effect on any visible pixel.
+    float mx = 0.5f * (piece.x0 + piece.x1);
+    float my = 0.5f * (piece.y0 + piece.y1);
+    int tx = int(mx / TILE);
+    int ty = min(int(my / TILE), m_tilesY - 1);
+    if (tx >= m_tilesX) return;
+
+    // keep rounding from pushing the piece out of its tile
+    float left = float(tx * TILE);
+    float top = float(ty * TILE);
+    float size = float(TILE);
+    Edge local = {
+        min(max(piece.x0 - left, 0.f), size), min(max(piece.y0 - top, 0.f), size),
+        min(max(piece.x1 - left, 0.f), size), min(max(piece.y1 - top, 0.f), size)
+    };
+    m_bins[size_t(ty) * m_tilesX + tx].push_back(local);
+
+    // the winding this piece adds to each scanline it crosses, which every
+    // tile further right inherits
+    float direction = local.y0 < local.y1 ? 1.f : -1.f;
+    float y0 = min(local.y0, local.y1);
+    float y1 = max(local.y0, local.y1);
+    float *carry = &m_carry[(size_t(ty) * m_tilesX + tx) * TILE];
+    for (int row = int(y0); row < TILE && row < y1; ++row)
+        carry[row] += direction * (min(float(row + 1), y1) - max(float(row), y0));
+}
+
+void FillRasterizer::BinEdge(const Edge &edge)
+{
+    // clip to the image vertically; nothing above or below it is visible
+    float y0 = edge.y0, y1 = edge.y1;
+    float x0 = edge.x0, x1 = edge.x1;
+    float height = float(m_height), width = float(m_width);
+    float dxdy = (x1 - x0) / (y1 - y0);
+
+    if (y0 > y1) { swap(y0, y1); swap(x0, x1); }
+    if (y1 <= 0.f || y0 >= height) return;
+    if (y0 < 0.f) { x0 += (0.f - y0) * dxdy; y0 = 0.f; }
+    if (y1 > height) { x1 -= (y1 - height) * dxdy; y1 = height; }
+    bool flipped = edge.y0 > edge.y1;
+
+    // cut along tile rows, then along tile columns; parts left of the
+    // image are moved onto its left edge, where they still carry winding
+    // into every pixel to their right
+    int firstRow = int(y0 / TILE);
+    for (int row = firstRow; row * TILE < y1; ++row)
+    {
+        float top = max(y0, float(row * TILE));
+        float bottom = min(y1, float((row + 1) * TILE));
+        if (bottom <= top) continue;
+
+        float xTop = x0 + (top - y0) * dxdy;
+        float xBottom = x0 + (bottom - y0) * dxdy;
+
+        // split where the piece crosses tile columns and the right side of
+        // the image, so that the visible part of every piece keeps its slope
+        m_cuts.clear();
+        m_cuts.push_back(0.f);
+        float xa = min(xTop, xBottom), xb = max(xTop, xBottom);
+        if (xb > xa)
+        {
+            for (int column = max(int(floor(xa / TILE)) + 1, 0);
+                 column * TILE < xb && column * TILE < width; ++column)
+                m_cuts.push_back((column * TILE - xTop) / (xBottom - xTop));
+            if (xa < width && xb > width)
+                m_cuts.push_back((width - xTop) / (xBottom - xTop));
+        }
+        m_cuts.push_back(1.f);
+        sort(m_cuts.begin(), m_cuts.end());
+
+        for (size_t c = 0; c + 1 < m_cuts.size(); ++c)
+        {
+            float t0 = m_cuts[c], t1 = m_cuts[c + 1];
+            if (t1 <= t0) continue;
+
+            Edge piece;
+            piece.y0 = top + t0 * (bottom - top);
+            piece.y1 = top + t1 * (bottom - top);
+            piece.x0 = min(max(xTop + t0 * (xBottom - xTop), 0.f), width);
+            piece.x1 = min(max(xTop + t1 * (xBottom - xTop), 0.f), width);
+            if (flipped) { swap(piece.x0, piece.x1); swap(piece.y0, piece.y1); }
+            AddPiece(piece);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void FillRasterizer::RasterizeTile(int tile, float *accumulation,
+                                   unsigned char *coverage, int stride) const
+{
+    // the accumulation buffer has two spare columns, for area that spills
+    // past the right side of the tile
+    const int ROW = TILE + 2;
+
+    int tx = tile % m_tilesX;
+    int ty = tile / m_tilesX;
+    int left = tx * TILE;
+    int top = ty * TILE;
+    int columns = min(TILE, m_width - left);
+    int rows = min(TILE, m_height - top);
+
+    // winding carried in from the tiles to the left
+    float carry[TILE];
+    for (int row = 0; row < TILE; ++row)
+        carry[row] = 0.f;
+    for (int x = 0; x < tx; ++x)
+    {
+        const float *from = &m_carry[(size_t(ty) * m_tilesX + x) * TILE];
+        for (int row = 0; row < TILE; ++row)
+            carry[row] += from[row];
+    }
+
+    const vector<Edge> &pieces = m_bins[tile];
+    if (pieces.empty())
+    {
+        // nothing crosses the tile, so every scanline is flat
+        for (int row = 0; row < rows; ++row)
+        {
+            unsigned char value = (unsigned char)(min(fabs(carry[row]), 1.f) * 255.f + 0.5f);
+            memset(coverage + size_t(top + row) * stride + left, value, columns);
+        }
+        return;
+    }
+
+    fill(accumulation, accumulation + TILE * ROW, 0.f);
+
+    for (size_t p = 0; p < pieces.size(); ++p)
+    {
+        const Edge &piece = pieces[p];
+        float direction = 1.f;
+        float x0 = piece.x0, y0 = piece.y0, x1 = piece.x1, y1 = piece.y1;
+        if (y0 > y1) {
+            swap(x0, x1);
+            swap(y0, y1);
+            direction = -1.f;
+        }
+        if (y1 - y0 <= 0.f) continue;
+
+        float dxdy = (x1 - x0) / (y1 - y0);
+        float x = x0;
+        for (int row = max(int(y0), 0); row < TILE && row < y1; ++row)
+        {
+            float *line = accumulation + row * ROW;
+            float dy = min(float(row + 1), y1) - max(float(row), y0);
+            // stepping can drift just outside the tile, so clamp each step
+            float xNext = min(max(x + dxdy * dy, 0.f), float(TILE));
+            float d = dy * direction;
+
+            float xa = min(x, xNext), xb = max(x, xNext);
+            float xaFloor = floor(xa);
+            int xai = int(xaFloor);
+            float xbCeil = ceil(xb);
+            int xbi = int(xbCeil);
+
+            if (xbi <= xai + 1)
+            {
+                // within one pixel: split by the average x
+                float xm = 0.5f * (x + xNext) - xaFloor;
+                line[xai] += d - d * xm;
+                line[xai + 1] += d * xm;
+            }
+            else
+            {
+                // across several pixels: triangle at each end, even slope
+                // in between
+                float s = 1.f / (xb - xa);
+                float xaf = xa - xaFloor;
+                float a0 = 0.5f * s * (1.f - xaf) * (1.f - xaf);
+                float xbf = xb - xbCeil + 1.f;
+                float am = 0.5f * s * xbf * xbf;
+
+                line[xai] += d * a0;
+                if (xbi == xai + 2)
+                    line[xai + 1] += d * (1.f - a0 - am);
+                else
+                {
+                    float a1 = s * (1.5f - xaf);
+                    line[xai + 1] += d * (a1 - a0);
+                    for (int xi = xai + 2; xi < xbi - 1; ++xi)
+                        line[xi] += d * s;
+                    float a2 = a1 + (xbi - xai - 3) * s;
+                    line[xbi - 1] += d * (1.f - a2 - am);
+                }
+                line[xbi] += d * am;
+            }
+            x = xNext;
+        }
+    }
+
+    // running sums along each scanline give the winding at every pixel
+    for (int row = 0; row < rows; ++row)
+    {
+        const float *line = accumulation + row * ROW;
+        unsigned char *out = coverage + size_t(top + row) * stride + left;
+        float sum = carry[row];
+        for (int column = 0; column < columns; ++column)
+        {
+            sum += line[column];
+            out[column] = (unsigned char)(min(fabs(sum), 1.f) * 255.f + 0.5f);
+        }
+    }
+}
+
+void FillRasterizer::Render(unsigned char *coverage, int stride)
+{
+    for (size_t t = 0; t < m_bins.size(); ++t)
+        m_bins[t].clear();
+    fill(m_carry.begin(), m_carry.end(), 0.f);
+
+    for (size_t e = 0; e < m_edges.size(); ++e)
+        BinEdge(m_edges[e]);
+
+    m_pool.ParallelFor(m_bins.size(), [&](size_t tile, unsigned int worker) {
+        vector<float> &accumulation = m_accumulation[worker];
+        accumulation.resize(TILE * (TILE + 2));
+        RasterizeTile(int(tile), &accumulation[0], coverage, stride);
+    }, 4);
+}
+
+// --------------------------------------------------------------------------
+
+void FillRasterizer::Composite(const unsigned char *coverage, int coverageStride,
+                               int width, int height, const float *colour,
+                               unsigned char *rgba, int rgbaStride)
+{
+    unsigned char source[3];
+    for (int c = 0; c < 3; ++c)
+        source[c] = (unsigned char)(min(max(colour[c], 0.f), 1.f) * 255.f + 0.5f);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char *alpha = coverage + size_t(y) * coverageStride;
+        unsigned char *pixel = rgba + size_t(y) * rgbaStride;
+        for (int x = 0; x < width; ++x, pixel += 4)
+        {
+            unsigned int a = alpha[x];
+            if (a == 0) continue;
+            for (int c = 0; c < 3; ++c)
+                pixel[c] = (unsigned char)((source[c] * a + pixel[c] * (255 - a) + 127) / 255);
+            pixel[3] = 255;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
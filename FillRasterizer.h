@@ -0,0 +1,100 @@
+// ==========================================================================
+// Filled Glyph Rasterizer
+//
+// Fills glyph outlines with anti-aliased coverage on the CPU, using the
+// nonzero winding rule. Rendering works in three steps:
+//  - contours are flattened (see BezierFlatten.h) into straight edges in
+//    pixel coordinates, and the edges are cut into pieces along a grid of
+//    square tiles, each piece stored with the tile it falls in
+//  - each tile row adds up, from left to right, how much winding the
+//    pieces in earlier tiles carry into every scanline of the next tile
+//  - tiles are rasterized in parallel on the shared ThreadPool. Each piece
+//    adds the exact area it covers in each pixel to an accumulation
+//    buffer, and a running sum along each scanline turns that into
+//    coverage. Tiles with no pieces are filled straight from the carry
+// Coverage is the absolute accumulated winding, clamped to one. This is the
+// nonzero rule except where edges of overlapping contours share a pixel,
+// which only changes the anti-aliasing of that pixel.
+//
+// Pixel coordinates have their origin at the top left, with y growing
+// downwards as in image files; outlines in EM units are flipped on input.
+// ==========================================================================
+#ifndef FILLRASTERIZER_H
+#define FILLRASTERIZER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "GlyphExtractor.h"
+#include "ThreadPool.h"
+
+// --------------------------------------------------------------------------
+
+class FillRasterizer
+{
+public:
+    // width and height of a tile, in pixels
+    static const int TILE = 32;
+
+private:
+    struct Edge
+    {
+        float   x0, y0, x1, y1;
+    };
+
+    int                 m_width;
+    int                 m_height;
+    int                 m_tilesX;
+    int                 m_tilesY;
+    float               m_tolerance;
+    ThreadPool         &m_pool;
+
+    std::vector<Edge>   m_edges;
+
+    // edge pieces of every tile, in tile-local coordinates, and the winding
+    // each tile carries into every scanline of the tile to its right
+    std::vector<std::vector<Edge> > m_bins;
+    std::vector<float>  m_carry;
+
+    // flattening and edge cutting buffers, and per-worker accumulation
+    // buffers
+    std::vector<float>  m_polyline;
+    std::vector<float>  m_cuts;
+    std::vector<std::vector<float> > m_accumulation;
+
+    void AddPiece(const Edge &piece);
+    void BinEdge(const Edge &edge);
+    void RasterizeTile(int tile, float *accumulation, unsigned char *coverage, int stride) const;
+
+public:
+    // tolerance is how far, in pixels, flattened edges may stray from the
+    // true outline
+    FillRasterizer(int width, int height, float tolerance = 0.2f,
+                   ThreadPool &pool = ThreadPool::Shared());
+
+    int Width() const   { return m_width; }
+    int Height() const  { return m_height; }
+
+    // removes every edge added so far
+    void Clear();
+
+    // adds an edge in pixel coordinates
+    void AddEdge(float x0, float y0, float x1, float y1);
+
+    // adds a glyph's outline, scaled to size pixels per EM, with its origin
+    // at pen position x on baseline y
+    void AddGlyph(const MyGlyph &glyph, float size, float x, float y);
+
+    // fills coverage, one byte per pixel with rows stride bytes apart, with
+    // the coverage of everything added so far
+    void Render(unsigned char *coverage, int stride);
+
+    // blends an r,g,b colour over an RGBA image of the same size, with rows
+    // stride bytes apart, in proportion to coverage
+    static void Composite(const unsigned char *coverage, int coverageStride,
+                          int width, int height, const float *colour,
+                          unsigned char *rgba, int rgbaStride);
+};
+
+// --------------------------------------------------------------------------
+#endif // FILLRASTERIZER_H
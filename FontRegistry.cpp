@@ -0,0 +1,203 @@
+// ==========================================================================
+// Font Face Registry
+//  - requires the FreeType development libraries: http://www.freetype.org
+//
+// See FontRegistry.h for an overview of the face registry.
+// ==========================================================================
+
+#include "FontRegistry.h"
+#include <iostream>
+
+#include FT_ADVANCES_H
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+FontFace::FontFace(const shared_ptr<FT_LibraryRec_> &library,
+                   const MappedFileHandle &mapping, FT_Face face,
+                   const string &filename, unsigned int id)
+    : m_library(library), m_mapping(mapping), m_face(face),
+      m_filename(filename), m_id(id)
+{}
+
+FontFace::~FontFace()
+{
+    // the library and mapping references are released after this, so both
+    // are still valid here
+    if (m_face) FT_Done_Face(m_face);
+}
+
+// --------------------------------------------------------------------------
+
+float FontFace::Advance(int character) const
+{
+    if (character < 0) return 0.f;
+
+    unsigned int page = unsigned(character) / ADVANCE_PAGE;
+    if (page >= m_advances.size() || m_advances[page].empty())
+        LoadAdvancePage(page);
+
+    return m_advances[page][unsigned(character) % ADVANCE_PAGE];
+}
+
+void FontFace::LoadAdvancePage(unsigned int page) const
+{
+    if (page >= m_advances.size()) m_advances.resize(page + 1);
+
+    std::vector<float> &advances = m_advances[page];
+    advances.assign(ADVANCE_PAGE, 0.f);
+    if (!m_face) return;
+
+    // unscaled advances come straight from the font's metrics tables
+    float em = m_face->units_per_EM;
+    for (unsigned int i = 0; i < ADVANCE_PAGE; ++i)
+    {
+        FT_UInt index = FT_Get_Char_Index(m_face, page * ADVANCE_PAGE + i);
+        FT_Fixed advance = 0;
+        if (FT_Get_Advance(m_face, index, FT_LOAD_NO_SCALE, &advance) == 0)
+            advances[i] = advance / em;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+FontRegistry::FontRegistry()
+    : m_nextId(1), m_mode(LOAD_MAPPED)
+{
+    // initialize freetype library once for every face in the registry
+    FT_Library library = 0;
+    FT_Error error = FT_Init_FreeType(&library);
+    if (error) {
+        cout << "ERROR: FreeType failed to initialize!" << endl;
+        return;
+    }
+    m_library = shared_ptr<FT_LibraryRec_>(library, FT_Done_FreeType);
+}
+
+FontRegistry::~FontRegistry()
+{
+    ReleaseAll();
+}
+
+FontRegistry &FontRegistry::Instance()
+{
+    static FontRegistry registry;
+    return registry;
+}
+
+// --------------------------------------------------------------------------
+
+FontHandle FontRegistry::Acquire(const string &filename)
+{
+    // reuse the face if this file has been opened before
+    map<string, FontHandle>::iterator it = m_faces.find(filename);
+    if (it != m_faces.end())
+        return it->second;
+
+    if (!m_library) return FontHandle();
+
+    MappedFileHandle mapping;
+    FT_Face face = OpenFace(m_library.get(), filename, mapping);
+    if (!face) return FontHandle();
+
+    FontHandle handle(new FontFace(m_library, mapping, face, filename, m_nextId++));
+    handle->LoadKerning();
+    m_faces[filename] = handle;
+    return handle;
+}
+
+FontHandle FontRegistry::OpenPrivate(const string &filename)
+{
+    // FreeType libraries are not thread-safe, so private faces get their own
+    FT_Library library = 0;
+    FT_Error error = FT_Init_FreeType(&library);
+    if (error) {
+        cout << "ERROR: FreeType failed to initialize!" << endl;
+        return FontHandle();
+    }
+    shared_ptr<FT_LibraryRec_> owner(library, FT_Done_FreeType);
+
+    MappedFileHandle mapping;
+    FT_Face face = OpenFace(library, filename, mapping);
+    if (!face) return FontHandle();
+
+    return FontHandle(new FontFace(owner, mapping, face, filename, m_nextId++));
+}
+
+// --------------------------------------------------------------------------
+
+MappedFileHandle FontRegistry::Map(const string &filename)
+{
+    // faces for the same file share the mapping for as long as any is open
+    MappedFileHandle mapping = m_mappings[filename].lock();
+    if (!mapping)
+    {
+        mapping = MapFile(filename);
+        m_mappings[filename] = mapping;
+    }
+    return mapping;
+}
+
+FT_Face FontRegistry::OpenFace(FT_Library library, const string &filename,
+                               MappedFileHandle &mapping)
+{
+    FT_Face face = 0;
+    FT_Error error;
+
+    if (m_mode == LOAD_MAPPED)
+    {
+        mapping = Map(filename);
+        if (!mapping) return 0;
+        error = FT_New_Memory_Face(library, mapping->Data(), FT_Long(mapping->Size()), 0, &face);
+    }
+    else
+    {
+        mapping.reset();
+        error = FT_New_Face(library, filename.c_str(), 0, &face);
+    }
+
+    if (error == FT_Err_Unknown_File_Format) {
+        cout << "Freetype ERROR: unsupported file format in " << filename << endl;
+        return 0;
+    }
+    else if (error) {
+        cout << "FreeType ERROR: unknown error occurred." << endl;
+        return 0;
+    }
+
+    return face;
+}
+
+// --------------------------------------------------------------------------
+
+void FontRegistry::ReleaseUnused()
+{
+    map<string, FontHandle>::iterator it = m_faces.begin();
+    while (it != m_faces.end())
+    {
+        // the registry's own reference is the only one left
+        if (it->second.use_count() == 1)
+            m_faces.erase(it++);
+        else
+            ++it;
+    }
+
+    // forget mappings whose last face has gone away
+    map<string, weak_ptr<const MappedFile> >::iterator m = m_mappings.begin();
+    while (m != m_mappings.end())
+    {
+        if (m->second.expired())
+            m_mappings.erase(m++);
+        else
+            ++m;
+    }
+}
+
+void FontRegistry::ReleaseAll()
+{
+    m_faces.clear();
+    ReleaseUnused();
+}
+
+// --------------------------------------------------------------------------
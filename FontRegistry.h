@@ -0,0 +1,150 @@
+// ==========================================================================
+// Font Face Registry
+//  - requires the FreeType development libraries: http://www.freetype.org
+//
+// This module keeps one FreeType library and one FT_Face per font file open
+// for the lifetime of the program, so that switching fonts or extracting
+// many glyphs does not re-open and re-parse the font file every time.
+//  - A FontFace owns a single FT_Face and keeps its library alive
+//  - The FontRegistry hands out shared, reference-counted FontFace handles,
+//    opening each file on first request and reusing it afterwards
+//  - By default font files are memory-mapped once and every face for the
+//    same file, shared or private, is created from that one mapping
+//  - Each face keeps a table of character advances, filled in on demand,
+//    so text can be measured without loading glyph outlines
+//  - Shared faces look up all of their kerning pairs when they are opened
+//
+// Faces are not thread-safe; a shared handle should only be used from one
+// thread at a time. Threads that need their own face for the same file can
+// open a private one, which gets its own FreeType library as well.
+// ==========================================================================
+#ifndef FONTREGISTRY_H
+#define FONTREGISTRY_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "Kerning.h"
+#include "MappedFile.h"
+
+// --------------------------------------------------------------------------
+// A single opened font face. The face holds a reference to the library it
+// was created from, so the library is only released after its last face,
+// and to the file mapping it reads from, if any.
+
+class FontFace
+{
+    std::shared_ptr<FT_LibraryRec_> m_library;
+    MappedFileHandle m_mapping;
+    FT_Face         m_face;
+    std::string     m_filename;
+    unsigned int    m_id;
+
+    // advances in EM units, in pages of ADVANCE_PAGE character codes; empty
+    // pages have not been looked up yet
+    mutable std::vector<std::vector<float> > m_advances;
+
+    // looks up the advances of every character in a page
+    void LoadAdvancePage(unsigned int page) const;
+
+    KerningTable    m_kerning;
+
+    // faces are owned through handles only
+    FontFace(const FontFace &);
+    FontFace &operator=(const FontFace &);
+
+public:
+    FontFace(const std::shared_ptr<FT_LibraryRec_> &library,
+             const MappedFileHandle &mapping, FT_Face face,
+             const std::string &filename, unsigned int id);
+    ~FontFace();
+
+    FT_Face Face() const                    { return m_face; }
+    const std::string &Filename() const     { return m_filename; }
+
+    // unique for every face opened during this run, usable as a cache key
+    unsigned int Id() const                 { return m_id; }
+
+    // advance width of a character in EM units, read from the font's metrics
+    // without loading the glyph outline; repeated lookups come from a table.
+    // Composite glyphs that borrow a component's metrics may report a
+    // slightly different advance here than their loaded outline does.
+    float Advance(int character) const;
+
+    static const unsigned int ADVANCE_PAGE = 256;
+
+    // kerning adjustments between characters, empty until LoadKerning
+    const KerningTable &Kerning() const     { return m_kerning; }
+    void LoadKerning()                      { m_kerning.Build(m_face); }
+};
+
+typedef std::shared_ptr<FontFace> FontHandle;
+
+// --------------------------------------------------------------------------
+// Process-wide registry of opened font faces, keyed by file name.
+
+class FontRegistry
+{
+public:
+    // how font files are read when a face is opened
+    enum LoadMode
+    {
+        LOAD_STREAMED,      // FreeType reads the file itself (FT_New_Face)
+        LOAD_MAPPED         // faces share one read-only mapping per file
+    };
+
+private:
+    std::shared_ptr<FT_LibraryRec_> m_library;
+    std::map<std::string, FontHandle> m_faces;
+    std::map<std::string, std::weak_ptr<const MappedFile> > m_mappings;
+    unsigned int m_nextId;
+    LoadMode m_mode;
+
+    FontRegistry();
+    FontRegistry(const FontRegistry &);
+    FontRegistry &operator=(const FontRegistry &);
+
+    // returns the mapping for a file, mapping it if no face is using it yet
+    MappedFileHandle Map(const std::string &filename);
+
+    // opens a face from the given library according to the load mode,
+    // printing any loading errors; mapping is set to the file mapping used
+    FT_Face OpenFace(FT_Library library, const std::string &filename,
+                     MappedFileHandle &mapping);
+
+public:
+    ~FontRegistry();
+
+    // the single registry instance used by all glyph extractors
+    static FontRegistry &Instance();
+
+    // returns the shared face for the given font file, opening it on first
+    // use; returns an empty handle if the file could not be loaded
+    FontHandle Acquire(const std::string &filename);
+
+    // opens a separate face for the given file with its own library, for use
+    // by a single worker thread; the face is not kept by the registry
+    FontHandle OpenPrivate(const std::string &filename);
+
+    // drops faces that are no longer referenced outside the registry
+    void ReleaseUnused();
+
+    // drops all of the registry's references; faces still in use elsewhere
+    // stay open until their last handle goes away
+    void ReleaseAll();
+
+    // number of faces currently held by the registry
+    size_t Size() const     { return m_faces.size(); }
+
+    // selects how faces opened from now on read their font files
+    void SetLoadMode(LoadMode mode)     { m_mode = mode; }
+    LoadMode GetLoadMode() const        { return m_mode; }
+};
+
+// --------------------------------------------------------------------------
+#endif // FONTREGISTRY_H
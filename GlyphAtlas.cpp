@@ -0,0 +1,222 @@
+// ==========================================================================
+// Distance Field Glyph Atlases
+//
+// See GlyphAtlas.h for an overview of the atlas and its metrics file.
+// ==========================================================================
+
+#include "GlyphAtlas.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// the stb_image_write implementation lives in SoftwareRenderer.cpp
+#include <stb_image_write.h>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+SkylinePacker::SkylinePacker(int width)
+    : m_width(width)
+{
+    Span floor = { 0, 0, width };
+    m_skyline.push_back(floor);
+}
+
+bool SkylinePacker::Pack(int width, int height, int &x, int &y)
+{
+    if (width > m_width) return false;
+
+    // try the rectangle's left edge at the start of every span, resting it
+    // on the highest span beneath it
+    size_t bestSpan = m_skyline.size();
+    int bestY = 0;
+    for (size_t i = 0; i < m_skyline.size(); ++i)
+    {
+        int left = m_skyline[i].x;
+        if (left + width > m_width) break;
+
+        int top = 0;
+        for (size_t j = i; j < m_skyline.size() && m_skyline[j].x < left + width; ++j)
+            top = max(top, m_skyline[j].y);
+
+        if (bestSpan == m_skyline.size() || top < bestY) {
+            bestSpan = i;
+            bestY = top;
+        }
+    }
+    if (bestSpan == m_skyline.size()) return false;
+
+    x = m_skyline[bestSpan].x;
+    y = bestY;
+
+    // replace the spans covered by the rectangle with its bottom edge,
+    // keeping what is left of the last one
+    Span placed = { x, y + height, width };
+    size_t end = bestSpan;
+    while (end < m_skyline.size() && m_skyline[end].x + m_skyline[end].width <= x + width)
+        ++end;
+    if (end < m_skyline.size() && m_skyline[end].x < x + width) {
+        int right = m_skyline[end].x + m_skyline[end].width;
+        m_skyline[end].x = x + width;
+        m_skyline[end].width = right - m_skyline[end].x;
+    }
+    m_skyline.erase(m_skyline.begin() + bestSpan, m_skyline.begin() + end);
+    m_skyline.insert(m_skyline.begin() + bestSpan, placed);
+
+    // merge neighbouring spans at the same height
+    for (size_t i = 0; i + 1 < m_skyline.size(); )
+    {
+        if (m_skyline[i].y == m_skyline[i + 1].y) {
+            m_skyline[i].width += m_skyline[i + 1].width;
+            m_skyline.erase(m_skyline.begin() + i + 1);
+        }
+        else ++i;
+    }
+    return true;
+}
+
+int SkylinePacker::Height() const
+{
+    int height = 0;
+    for (size_t i = 0; i < m_skyline.size(); ++i)
+        height = max(height, m_skyline[i].y);
+    return height;
+}
+
+// --------------------------------------------------------------------------
+
+GlyphAtlas::GlyphAtlas()
+    : m_width(0), m_height(0), m_size(0.f), m_range(0.f)
+{}
+
+bool GlyphAtlas::Build(const GlyphExtractor &extractor, const vector<int> &characters,
+                       float size, float range, int width, ThreadPool &pool)
+{
+    m_width = m_height = 0;
+    m_size = size;
+    m_range = range;
+    m_pixels.clear();
+    m_glyphs.clear();
+
+    // one glyph per character, in character order
+    vector<int> sorted(characters);
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    if (sorted.empty()) return true;
+
+    vector<MyGlyph> glyphs = extractor.ExtractGlyphs(&sorted[0], sorted.size());
+    vector<DistanceField> fields;
+    GenerateMultiChannelFields(glyphs, size, range, fields, pool);
+
+    // pick a width that makes the image roughly square
+    size_t area = 0;
+    int widest = 0;
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        area += size_t(fields[i].width + ATLAS_PADDING) * (fields[i].height + ATLAS_PADDING);
+        widest = max(widest, fields[i].width + ATLAS_PADDING);
+    }
+    if (width <= 0)
+    {
+        width = 1;
+        while (width < widest || size_t(width) * width < area) width *= 2;
+    }
+
+    // place the tallest glyphs first, so each row of the skyline stays
+    // nearly level
+    vector<size_t> order(fields.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    stable_sort(order.begin(), order.end(),
+                [&](size_t a, size_t b) { return fields[a].height > fields[b].height; });
+
+    m_glyphs.resize(fields.size());
+    SkylinePacker packer(width);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const DistanceField &field = fields[order[i]];
+        AtlasGlyph &glyph = m_glyphs[order[i]];
+        glyph.character = sorted[order[i]];
+        glyph.advance = glyphs[order[i]].advance;
+        glyph.x = glyph.y = 0;
+        glyph.width = (unsigned short)field.width;
+        glyph.height = (unsigned short)field.height;
+        glyph.left = field.left / size;
+        glyph.top = field.top / size;
+        if (field.width == 0 || field.height == 0) continue;
+
+        // the padding goes to the right of and below each glyph
+        int x, y;
+        if (!packer.Pack(field.width + ATLAS_PADDING, field.height + ATLAS_PADDING, x, y)
+            || x > 0xffff || y > 0xffff)
+        {
+            cout << "GlyphAtlas ERROR: glyph " << glyph.character << " does not fit in "
+                 << width << " pixels" << endl;
+            m_glyphs.clear();
+            return false;
+        }
+        glyph.x = (unsigned short)x;
+        glyph.y = (unsigned short)y;
+    }
+
+    m_width = width;
+    m_height = max(packer.Height(), 1);
+    m_pixels.assign(size_t(m_width) * m_height * 3, 0);
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        const DistanceField &field = fields[i];
+        const AtlasGlyph &glyph = m_glyphs[i];
+        for (int row = 0; row < field.height; ++row)
+            memcpy(&m_pixels[(size_t(glyph.y + row) * m_width + glyph.x) * 3],
+                   &field.pixels[size_t(row) * field.width * 3], size_t(field.width) * 3);
+    }
+    return true;
+}
+
+const AtlasGlyph *GlyphAtlas::Find(int character) const
+{
+    vector<AtlasGlyph>::const_iterator glyph = lower_bound(m_glyphs.begin(), m_glyphs.end(), character,
+        [](const AtlasGlyph &g, int c) { return g.character < c; });
+    if (glyph == m_glyphs.end() || glyph->character != character) return 0;
+    return &*glyph;
+}
+
+// --------------------------------------------------------------------------
+
+bool GlyphAtlas::WritePNG(const string &filename) const
+{
+    if (m_pixels.empty()
+        || !stbi_write_png(filename.c_str(), m_width, m_height, 3, &m_pixels[0], m_width * 3))
+    {
+        cout << "GlyphAtlas ERROR: Could not write " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+bool GlyphAtlas::WriteMetrics(const string &filename) const
+{
+    AtlasHeader header;
+    memcpy(header.magic, GLYPH_ATLAS_MAGIC, 4);
+    header.version = GLYPH_ATLAS_VERSION;
+    header.glyphCount = unsigned(m_glyphs.size());
+    header.width = unsigned(m_width);
+    header.height = unsigned(m_height);
+    header.size = m_size;
+    header.range = m_range;
+
+    ofstream output(filename.c_str(), ios::binary);
+    if (!output) {
+        cout << "GlyphAtlas ERROR: Could not write " << filename << endl;
+        return false;
+    }
+
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!m_glyphs.empty())
+        output.write(reinterpret_cast<const char *>(&m_glyphs[0]), m_glyphs.size() * sizeof(AtlasGlyph));
+    return bool(output);
+}
+
+// --------------------------------------------------------------------------
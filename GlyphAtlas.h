@@ -0,0 +1,127 @@
+// ==========================================================================
+// Distance Field Glyph Atlases
+//
+// A glyph atlas holds the multi-channel distance fields (see DistanceField.h)
+// of a set of glyphs packed into one RGB image, with a table saying where
+// each glyph is, so that text can be drawn with one textured quad per glyph
+// instead of one patch per curve segment.
+//  - fields are generated in parallel on the shared ThreadPool, one glyph
+//    per task
+//  - glyph images are placed tallest first by a SkylinePacker, a gap of
+//    ATLAS_PADDING pixels apart so that filtering never mixes two glyphs
+//  - the image is written as a PNG, and the table as a metrics file: an
+//    AtlasHeader followed by one AtlasGlyph record per glyph, sorted by
+//    character code, in the byte order of the machine that wrote it
+// ==========================================================================
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <string>
+#include <vector>
+
+#include "DistanceField.h"
+#include "GlyphExtractor.h"
+#include "ThreadPool.h"
+
+// --------------------------------------------------------------------------
+// FILE FORMAT
+
+#define GLYPH_ATLAS_MAGIC       "GATL"
+#define GLYPH_ATLAS_VERSION     1
+
+// empty pixels between neighbouring glyphs in the image
+const int ATLAS_PADDING = 1;
+
+struct AtlasHeader
+{
+    char            magic[4];
+    unsigned int    version;
+    unsigned int    glyphCount;
+    unsigned int    width, height;  // of the image, in pixels
+    float           size;           // pixels per EM the fields were made at
+    float           range;          // pixels of distance from 0 to 255
+};
+
+struct AtlasGlyph
+{
+    int             character;
+    float           advance;        // in EM units
+
+    // the glyph's rectangle in the image, in pixels from the top left;
+    // empty for glyphs with no outline
+    unsigned short  x, y, width, height;
+
+    // where the rectangle's top left corner goes relative to the glyph
+    // origin, in EM units with y upwards
+    float           left, top;
+};
+
+// --------------------------------------------------------------------------
+// Places rectangles in a strip of fixed width by keeping the skyline: the
+// height of the highest rectangle so far at every x. Each rectangle goes
+// wherever its top edge would be lowest, left-most among equals, with y
+// growing downwards as in images.
+
+class SkylinePacker
+{
+    struct Span
+    {
+        int     x, y, width;
+    };
+
+    int                 m_width;
+    std::vector<Span>   m_skyline;
+
+public:
+    explicit SkylinePacker(int width);
+
+    // finds a place for a rectangle, returning false if it is wider than
+    // the strip
+    bool Pack(int width, int height, int &x, int &y);
+
+    // the lowest point of any rectangle placed so far
+    int Height() const;
+};
+
+// --------------------------------------------------------------------------
+
+class GlyphAtlas
+{
+    int                         m_width;
+    int                         m_height;
+    float                       m_size;
+    float                       m_range;
+    std::vector<unsigned char>  m_pixels;
+    std::vector<AtlasGlyph>     m_glyphs;
+
+public:
+    GlyphAtlas();
+
+    // Builds an atlas of the given characters, with fields at size pixels
+    // per EM. A width of zero picks the smallest power of two that keeps
+    // the image about square. Prints an error and returns false if a glyph
+    // does not fit.
+    bool Build(const GlyphExtractor &extractor, const std::vector<int> &characters,
+               float size, float range = DEFAULT_DISTANCE_RANGE, int width = 0,
+               ThreadPool &pool = ThreadPool::Shared());
+
+    int Width() const       { return m_width; }
+    int Height() const      { return m_height; }
+    float Size() const      { return m_size; }
+    float Range() const     { return m_range; }
+
+    // rows of RGB pixels, top row first
+    const unsigned char *Pixels() const     { return m_pixels.empty() ? 0 : &m_pixels[0]; }
+
+    // sorted by character code
+    const std::vector<AtlasGlyph> &Glyphs() const   { return m_glyphs; }
+
+    // the glyph for a character, or null if the atlas does not have it
+    const AtlasGlyph *Find(int character) const;
+
+    bool WritePNG(const std::string &filename) const;
+    bool WriteMetrics(const std::string &filename) const;
+};
+
+// --------------------------------------------------------------------------
+#endif // GLYPHATLAS_H
@@ -0,0 +1,123 @@
+// ==========================================================================
+// Glyph Outline Cache
+//
+// See GlyphCache.h for an overview of the glyph cache.
+// ==========================================================================
+
+#include "GlyphCache.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+GlyphCache::GlyphCache(size_t budget)
+    : m_budget(budget), m_bytes(0), m_hits(0), m_misses(0), m_evictions(0)
+{}
+
+GlyphCache &GlyphCache::Instance()
+{
+    static GlyphCache cache;
+    return cache;
+}
+
+unsigned long long GlyphCache::Key(unsigned int face, int character)
+{
+    return (static_cast<unsigned long long>(face) << 32)
+         | static_cast<unsigned int>(character);
+}
+
+size_t GlyphCache::GlyphBytes(const MyPackedGlyph &glyph)
+{
+    // approximate heap footprint of an entry, including list and index nodes
+    return sizeof(Entry) + 4 * sizeof(void *) + glyph.Bytes();
+}
+
+// --------------------------------------------------------------------------
+
+bool GlyphCache::Find(unsigned int face, int character, MyPackedGlyph &glyph)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    unordered_map<unsigned long long, EntryList::iterator>::iterator it =
+        m_index.find(Key(face, character));
+    if (it == m_index.end()) {
+        ++m_misses;
+        return false;
+    }
+
+    // move the entry to the front of the LRU list
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    ++m_hits;
+
+    glyph = it->second->glyph;
+    return true;
+}
+
+void GlyphCache::Insert(unsigned int face, int character, const MyPackedGlyph &glyph)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    unsigned long long key = Key(face, character);
+    unordered_map<unsigned long long, EntryList::iterator>::iterator it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_bytes -= it->second->bytes;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.glyph = glyph;
+    entry.bytes = GlyphBytes(entry.glyph);
+
+    m_entries.push_front(entry);
+    m_index[key] = m_entries.begin();
+    m_bytes += entry.bytes;
+
+    Evict();
+}
+
+void GlyphCache::Evict()
+{
+    // always keep the entry that was just used, even if it alone is too big
+    while (m_bytes > m_budget && m_entries.size() > 1)
+    {
+        Entry &last = m_entries.back();
+        m_bytes -= last.bytes;
+        m_index.erase(last.key);
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void GlyphCache::SetBudget(size_t bytes)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_budget = bytes;
+    Evict();
+}
+
+void GlyphCache::Clear()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+void GlyphCache::ResetCounters()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_hits = m_misses = m_evictions = 0;
+}
+
+size_t GlyphCache::Budget() const       { lock_guard<mutex> lock(m_mutex); return m_budget; }
+size_t GlyphCache::Bytes() const        { lock_guard<mutex> lock(m_mutex); return m_bytes; }
+size_t GlyphCache::Size() const         { lock_guard<mutex> lock(m_mutex); return m_entries.size(); }
+size_t GlyphCache::Hits() const         { lock_guard<mutex> lock(m_mutex); return m_hits; }
+size_t GlyphCache::Misses() const       { lock_guard<mutex> lock(m_mutex); return m_misses; }
+size_t GlyphCache::Evictions() const    { lock_guard<mutex> lock(m_mutex); return m_evictions; }
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,85 @@
+// ==========================================================================
+// Glyph Outline Cache
+//
+// This module keeps decoded glyph outlines in memory, keyed by the font face
+// they came from and their character code, so that repeated letters and
+// repeated layouts of the same text do not go back to FreeType.
+//  - Entries are evicted least-recently-used first once the cache grows past
+//    its memory budget
+//  - Hit and miss counters are kept for tuning the budget
+//
+// The cache may be shared between threads; all operations lock internally.
+// ==========================================================================
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "GlyphExtractor.h"
+
+// --------------------------------------------------------------------------
+
+class GlyphCache
+{
+    struct Entry
+    {
+        unsigned long long  key;
+        size_t              bytes;
+        MyPackedGlyph       glyph;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    // most recently used entries are kept at the front of the list
+    EntryList   m_entries;
+    std::unordered_map<unsigned long long, EntryList::iterator> m_index;
+
+    size_t      m_budget;
+    size_t      m_bytes;
+    size_t      m_hits;
+    size_t      m_misses;
+    size_t      m_evictions;
+
+    mutable std::mutex m_mutex;
+
+    static unsigned long long Key(unsigned int face, int character);
+    static size_t GlyphBytes(const MyPackedGlyph &glyph);
+
+    // drops least recently used entries until the cache fits its budget
+    void Evict();
+
+public:
+    // default memory budget, in bytes
+    static const size_t DEFAULT_BUDGET = 4 * 1024 * 1024;
+
+    explicit GlyphCache(size_t budget = DEFAULT_BUDGET);
+
+    // the cache used by all glyph extractors
+    static GlyphCache &Instance();
+
+    // sets glyph to the cached glyph for this face and character and returns
+    // true, or returns false if it has not been cached; the returned glyph
+    // shares its storage with the cache entry
+    bool Find(unsigned int face, int character, MyPackedGlyph &glyph);
+
+    // stores a decoded glyph, replacing any previous entry for the same key
+    void Insert(unsigned int face, int character, const MyPackedGlyph &glyph);
+
+    // changes the memory budget, evicting entries if it shrank
+    void SetBudget(size_t bytes);
+
+    void Clear();
+    void ResetCounters();
+
+    size_t Budget() const;
+    size_t Bytes() const;
+    size_t Size() const;
+    size_t Hits() const;
+    size_t Misses() const;
+    size_t Evictions() const;
+};
+
+// --------------------------------------------------------------------------
+#endif // GLYPHCACHE_H
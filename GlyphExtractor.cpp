@@ -17,45 +17,77 @@
 // ==========================================================================
 
 #include "GlyphExtractor.h"
+#include "GlyphCache.h"
+#include "GlyphPack.h"
+#include "ThreadPool.h"
+#include <algorithm>
 #include <iostream>
 
 // set this true to print information about the font loaded and glyphs extracted
 #define DEBUG_PRINT 0
 
+// number of glyphs a worker decodes at a time in ExtractGlyphs
+#define BATCH_GRAIN 4
+
 using namespace std;
 
 // --------------------------------------------------------------------------
 
 GlyphExtractor::GlyphExtractor()
     : m_face(0)
-{
-    // initialize freetype library
-    FT_Error error = FT_Init_FreeType(&m_library);
-    if (error) {
-        cout << "ERROR: FreeType failed to initialize!" << endl;
-    }
-}
+{}
 
 // --------------------------------------------------------------------------
 
 bool GlyphExtractor::LoadFontFile(const string &filename)
 {
-    FT_Error error = FT_New_Face(m_library, filename.c_str(), 0, &m_face);
+    // the registry opens the file once and reports any loading errors
+    FontHandle font = FontRegistry::Instance().Acquire(filename);
+    if (!font) return false;
 
-    if (error == FT_Err_Unknown_File_Format) {
-        cout << "Freetype ERROR: unsupported file format in " << filename << endl;
-        return false;
-    }
-    else if (error) {
-        cout << "FreeType ERROR: unknown error occurred." << endl;
-        return false;
-    }
+    m_font = font;
+    m_face = m_font->Face();
+    m_workerFaces.clear();
 
     if (DEBUG_PRINT) PrintFontInformation();
 
     return true;
 }
 
+bool GlyphExtractor::LoadGlyphPack(const string &filename)
+{
+    GlyphPackHandle pack = ::LoadGlyphPack(filename);
+    if (!pack) return false;
+
+    m_pack = pack;
+    return true;
+}
+
+const KerningTable &GlyphExtractor::Kerning() const
+{
+    static const KerningTable none;
+
+    if (m_pack) return m_pack->Kerning();
+    if (m_font) return m_font->Kerning();
+    return none;
+}
+
+vector<int> GlyphExtractor::CharacterCodes() const
+{
+    vector<int> characters;
+    if (!m_face) return characters;
+
+    // walk the face's active character map
+    FT_UInt index = 0;
+    FT_ULong character = FT_Get_First_Char(m_face, &index);
+    while (index != 0)
+    {
+        characters.push_back(int(character));
+        character = FT_Get_Next_Char(m_face, character, &index);
+    }
+    return characters;
+}
+
 // --------------------------------------------------------------------------
 
 void GlyphExtractor::PrintFontInformation() const
@@ -89,42 +121,214 @@ void GlyphExtractor::PrintGlyphInformation(int character) const
 }
 
 // --------------------------------------------------------------------------
+// Packed glyph storage
 
-MyGlyph GlyphExtractor::ExtractGlyph(int character) const
+static const unsigned int HEADER_WORDS = sizeof(MyPackedGlyphHeader) / sizeof(unsigned int);
+
+MyPackedGlyph::MyPackedGlyph()
+    : m_header(0)
+{}
+
+MyPackedGlyph::MyPackedGlyph(const shared_ptr<const void> &owner, const void *block)
+    : m_owner(owner), m_header(static_cast<const MyPackedGlyphHeader *>(block))
+{}
+
+size_t MyPackedGlyph::BlockBytes(unsigned int contours, const unsigned int segments[3])
 {
-    // first check that a font has been loaded
-    if (!m_face) {
-        cout << "GlyphExtractor ERROR: No font loaded!" << endl;
-        return MyGlyph();
+    // in size_t, so that counts read from a file cannot wrap
+    size_t words = HEADER_WORDS + (size_t(contours) + 1) * 3;
+    size_t bytes = 0;
+    for (int d = 1; d <= 3; ++d) {
+        words += size_t(segments[d-1]) * (d + 1) * 2;
+        bytes += segments[d-1];
     }
+    // degree bytes are padded so consecutive blocks stay word aligned
+    return words * sizeof(unsigned int) + ((bytes + 3) & ~size_t(3));
+}
 
-    // look up the glyph index for the given character code
-    int index = FT_Get_Char_Index(m_face, character);
+size_t MyPackedGlyph::Bytes() const
+{
+    if (!m_header) return 0;
+    return BlockBytes(m_header->contourCount, m_header->segmentCount);
+}
 
-    // load the glyph for the given character into the face glyph slot,
-    // keeping the outline in original font units
-    FT_Error error = FT_Load_Glyph(m_face, index, FT_LOAD_NO_SCALE);
-    if (error || m_face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+float MyPackedGlyph::Advance() const
+{
+    return m_header ? m_header->advance : 0.f;
+}
+
+unsigned int MyPackedGlyph::ContourCount() const
+{
+    return m_header ? m_header->contourCount : 0;
+}
+
+unsigned int MyPackedGlyph::SegmentCount(unsigned int degree) const
+{
+    if (!m_header || degree < 1 || degree > 3) return 0;
+    return m_header->segmentCount[degree-1];
+}
+
+unsigned int MyPackedGlyph::SegmentCount() const
+{
+    return SegmentCount(1) + SegmentCount(2) + SegmentCount(3);
+}
+
+const unsigned int *MyPackedGlyph::ContourTable() const
+{
+    return reinterpret_cast<const unsigned int *>(m_header) + HEADER_WORDS;
+}
+
+const float *MyPackedGlyph::Points(unsigned int degree) const
+{
+    if (!m_header || degree < 1 || degree > 3) return 0;
+
+    const float *points = reinterpret_cast<const float *>(
+        ContourTable() + (size_t(m_header->contourCount) + 1) * 3);
+    for (unsigned int d = 1; d < degree; ++d)
+        points += size_t(m_header->segmentCount[d-1]) * (d + 1) * 2;
+    return points;
+}
+
+unsigned int MyPackedGlyph::ContourBegin(unsigned int c, unsigned int degree) const
+{
+    if (!m_header || degree < 1 || degree > 3) return 0;
+    return ContourTable()[size_t(c) * 3 + degree - 1];
+}
+
+const unsigned char *MyPackedGlyph::Degrees() const
+{
+    if (!m_header) return 0;
+
+    // the degree bytes follow the last cubic control point
+    const float *end = Points(3) + size_t(m_header->segmentCount[2]) * 4 * 2;
+    return reinterpret_cast<const unsigned char *>(end);
+}
+
+// --------------------------------------------------------------------------
+// Helpers to build packed glyphs. Outlines are walked twice: once with a
+// counter to size the block, then with a builder that fills it in.
+
+namespace {
+
+struct SegmentCounter
+{
+    unsigned int contours;
+    unsigned int segments[3];
+
+    SegmentCounter() : contours(0)
+    { segments[0] = segments[1] = segments[2] = 0; }
+
+    void BeginContour()     { ++contours; }
+
+    void AddSegment(const MySegment &segment)
     {
-        cout << "FreeType ERROR: Could not find glyph outline for character "
-             << character << " (" << char(character) << ")" <<  endl;
-        return MyGlyph();
+        if (segment.degree >= 1 && segment.degree <= 3)
+            ++segments[segment.degree-1];
     }
+};
 
-    if (DEBUG_PRINT) PrintGlyphInformation(character);
+class PackedGlyphBuilder
+{
+    shared_ptr<unsigned int> m_block;
+    MyPackedGlyphHeader *m_header;
+    unsigned int *m_contours;
+    float *m_points[3];
+    unsigned int m_next[3];
+    unsigned char *m_degrees;
+    unsigned int m_contour;
+
+public:
+    PackedGlyphBuilder(float advance, const SegmentCounter &counts)
+        : m_contour(0)
+    {
+        size_t bytes = MyPackedGlyph::BlockBytes(counts.contours, counts.segments);
+        size_t words = bytes / sizeof(unsigned int);
+        m_block = shared_ptr<unsigned int>(new unsigned int[words](),
+                                           default_delete<unsigned int[]>());
+
+        m_header = reinterpret_cast<MyPackedGlyphHeader *>(m_block.get());
+        m_header->advance = advance;
+        m_header->contourCount = counts.contours;
+
+        m_contours = m_block.get() + HEADER_WORDS;
+        float *points = reinterpret_cast<float *>(m_contours + (counts.contours + 1) * 3);
+        for (int d = 1; d <= 3; ++d)
+        {
+            m_header->segmentCount[d-1] = counts.segments[d-1];
+            m_points[d-1] = points;
+            m_next[d-1] = 0;
+            points += counts.segments[d-1] * (d + 1) * 2;
+        }
+        m_degrees = reinterpret_cast<unsigned char *>(points);
+    }
 
-    // create a new glyph structure to populate with this character outline
-    FT_Outline &outline = m_face->glyph->outline;
-    float em = m_face->units_per_EM;
-    MyGlyph glyph(m_face->glyph->advance.x / em);
+    void BeginContour()
+    {
+        for (int d = 0; d < 3; ++d)
+            m_contours[m_contour * 3 + d] = m_next[d];
+        ++m_contour;
+    }
+
+    void AddSegment(const MySegment &segment)
+    {
+        unsigned int d = segment.degree;
+        if (d < 1 || d > 3) return;
+
+        float *points = m_points[d-1] + m_next[d-1] * (d + 1) * 2;
+        for (unsigned int i = 0; i <= d; ++i) {
+            points[2*i]   = segment.x[i];
+            points[2*i+1] = segment.y[i];
+        }
+        ++m_next[d-1];
+        *m_degrees++ = static_cast<unsigned char>(d);
+    }
+
+    MyPackedGlyph Finish()
+    {
+        // close the contour table with the end of the last contour
+        for (int d = 0; d < 3; ++d)
+            m_contours[m_contour * 3 + d] = m_next[d];
+        return MyPackedGlyph(m_block, m_block.get());
+    }
+};
+
+struct GlyphBuilder
+{
+    MyGlyph &glyph;
+
+    GlyphBuilder(MyGlyph &g) : glyph(g)
+    {}
+
+    void BeginContour()     { glyph.contours.push_back(MyContour()); }
 
+    void AddSegment(const MySegment &segment)
+    {
+        glyph.contours.back().push_back(segment);
+    }
+};
+
+template <typename Sink>
+void WalkGlyph(const MyGlyph &glyph, Sink &sink)
+{
+    for (size_t c = 0; c < glyph.contours.size(); ++c)
+    {
+        sink.BeginContour();
+        for (size_t s = 0; s < glyph.contours[c].size(); ++s)
+            sink.AddSegment(glyph.contours[c][s]);
+    }
+}
+
+// converts a FreeType outline in font units into segments in EM units
+template <typename Sink>
+void WalkOutline(const FT_Outline &outline, float em, Sink &sink)
+{
     // current point index
     int begin = 0;
 
     // iterate through the outline's contours
     for (int c = 0; c < outline.n_contours; ++c)
     {
-        MyContour contour;
+        sink.BeginContour();
 
         // iterate through current contour's points
         int end = outline.contours[c];
@@ -196,17 +400,241 @@ MyGlyph GlyphExtractor::ExtractGlyph(int character) const
             }
 
             // add segment to contour
-            contour.push_back(segment);
+            sink.AddSegment(segment);
         }
 
         // set beginning of next contour
         begin = end + 1;
+    }
+}
 
-        // add contour to glyph
-        glyph.contours.push_back(contour);
+} // namespace
+
+MyPackedGlyph PackGlyph(const MyGlyph &glyph)
+{
+    SegmentCounter counter;
+    WalkGlyph(glyph, counter);
+
+    PackedGlyphBuilder builder(glyph.advance, counter);
+    WalkGlyph(glyph, builder);
+    return builder.Finish();
+}
+
+MyGlyph UnpackGlyph(const MyPackedGlyph &packed)
+{
+    MyGlyph glyph(packed.Advance());
+    glyph.contours.resize(packed.ContourCount());
+
+    // segments are taken from their degree buckets in original outline order
+    const unsigned char *degrees = packed.Degrees();
+    unsigned int next[3] = { 0, 0, 0 };
+
+    for (unsigned int c = 0; c < packed.ContourCount(); ++c)
+    {
+        unsigned int count = 0;
+        for (unsigned int d = 1; d <= 3; ++d)
+            count += packed.ContourBegin(c+1, d) - packed.ContourBegin(c, d);
+
+        MyContour &contour = glyph.contours[c];
+        contour.reserve(count);
+        for (unsigned int s = 0; s < count; ++s)
+        {
+            unsigned int d = *degrees++;
+            const float *points = packed.Points(d) + next[d-1]++ * (d + 1) * 2;
+
+            MySegment segment(d);
+            for (unsigned int i = 0; i <= d; ++i) {
+                segment.x[i] = points[2*i];
+                segment.y[i] = points[2*i+1];
+            }
+            contour.push_back(segment);
+        }
+    }
+
+    return glyph;
+}
+
+// --------------------------------------------------------------------------
+
+MyGlyph GlyphExtractor::ExtractGlyph(int character) const
+{
+    return UnpackGlyph(ExtractPackedGlyph(character));
+}
+
+MyPackedGlyph GlyphExtractor::ExtractPackedGlyph(int character) const
+{
+    // precompiled glyphs need no decoding or caching at all
+    MyPackedGlyph glyph;
+    if (m_pack && m_pack->Find(character, glyph))
+        return glyph;
+
+    // otherwise check that a font has been loaded
+    if (!m_face) {
+        cout << "GlyphExtractor ERROR: No font loaded!" << endl;
+        return MyPackedGlyph();
     }
 
+    // glyphs already decoded from this face are served from the cache
+    GlyphCache &cache = GlyphCache::Instance();
+    if (cache.Find(m_font->Id(), character, glyph))
+        return glyph;
+
+    glyph = DecodeGlyph(m_face, character);
+    cache.Insert(m_font->Id(), character, glyph);
+
+    if (DEBUG_PRINT) PrintGlyphInformation(character);
     return glyph;
 }
 
 // --------------------------------------------------------------------------
+
+float GlyphExtractor::ExtractAdvance(int character) const
+{
+    float advance = 0.f;
+    ExtractAdvances(&character, 1, &advance);
+    return advance;
+}
+
+float GlyphExtractor::ExtractAdvances(const int *characters, size_t count, float *advances) const
+{
+    if (!m_pack && !m_font) {
+        cout << "GlyphExtractor ERROR: No font loaded!" << endl;
+        return 0.f;
+    }
+
+    // advances come from the pack index or the face's advance table, so no
+    // glyph outline is ever loaded here
+    float total = 0.f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float advance = 0.f;
+        if ((!m_pack || !m_pack->FindAdvance(characters[i], advance)) && m_font)
+            advance = m_font->Advance(characters[i]);
+
+        advances[i] = advance;
+        total += advance;
+    }
+    return total;
+}
+
+// --------------------------------------------------------------------------
+
+vector<MyGlyph> GlyphExtractor::ExtractGlyphs(const int *characters, size_t count) const
+{
+    vector<MyPackedGlyph> packed = ExtractPackedGlyphs(characters, count);
+
+    vector<MyGlyph> glyphs(count);
+    for (size_t i = 0; i < count; ++i)
+        glyphs[i] = UnpackGlyph(packed[i]);
+    return glyphs;
+}
+
+vector<MyPackedGlyph> GlyphExtractor::ExtractPackedGlyphs(const int *characters, size_t count) const
+{
+    vector<MyPackedGlyph> glyphs(count);
+
+    // take what we can from the glyph pack
+    vector<size_t> unpacked;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!m_pack || !m_pack->Find(characters[i], glyphs[i]))
+            unpacked.push_back(i);
+    }
+    if (unpacked.empty()) return glyphs;
+
+    // then check that a font has been loaded
+    if (!m_face) {
+        cout << "GlyphExtractor ERROR: No font loaded!" << endl;
+        return glyphs;
+    }
+
+    // take what we can from the cache, and collect each missing character once
+    GlyphCache &cache = GlyphCache::Instance();
+    vector<int> missing;
+    for (size_t i = 0; i < unpacked.size(); ++i)
+    {
+        size_t j = unpacked[i];
+        if (!cache.Find(m_font->Id(), characters[j], glyphs[j]))
+            missing.push_back(characters[j]);
+    }
+    if (missing.empty()) return glyphs;
+
+    sort(missing.begin(), missing.end());
+    missing.erase(unique(missing.begin(), missing.end()), missing.end());
+
+    // worker 0 is the calling thread and uses the shared face; every other
+    // worker gets a private face, since a single face is not thread-safe
+    ThreadPool &pool = ThreadPool::Shared();
+    bool parallel = pool.Size() > 1 && missing.size() > BATCH_GRAIN;
+    if (parallel)
+    {
+        if (m_workerFaces.size() < pool.Size()) m_workerFaces.resize(pool.Size());
+        m_workerFaces[0] = m_font;
+        for (unsigned int w = 1; w < pool.Size() && parallel; ++w)
+        {
+            if (!m_workerFaces[w])
+                m_workerFaces[w] = FontRegistry::Instance().OpenPrivate(m_font->Filename());
+            parallel = bool(m_workerFaces[w]);
+        }
+    }
+
+    vector<MyPackedGlyph> decoded(missing.size());
+    if (parallel)
+    {
+        const vector<FontHandle> &faces = m_workerFaces;
+        pool.ParallelFor(missing.size(), [&](size_t i, unsigned int worker) {
+            decoded[i] = DecodeGlyph(faces[worker]->Face(), missing[i]);
+        }, BATCH_GRAIN);
+    }
+    else
+    {
+        for (size_t i = 0; i < missing.size(); ++i)
+            decoded[i] = DecodeGlyph(m_face, missing[i]);
+    }
+
+    for (size_t i = 0; i < missing.size(); ++i)
+        cache.Insert(m_font->Id(), missing[i], decoded[i]);
+
+    // fill in the gaps, in input order
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (glyphs[i].Empty())
+        {
+            size_t j = lower_bound(missing.begin(), missing.end(), characters[i]) - missing.begin();
+            glyphs[i] = decoded[j];
+        }
+    }
+
+    return glyphs;
+}
+
+// --------------------------------------------------------------------------
+
+MyPackedGlyph GlyphExtractor::DecodeGlyph(FT_Face face, int character)
+{
+    // look up the glyph index for the given character code
+    int index = FT_Get_Char_Index(face, character);
+
+    // load the glyph for the given character into the face glyph slot,
+    // keeping the outline in original font units
+    FT_Error error = FT_Load_Glyph(face, index, FT_LOAD_NO_SCALE);
+    if (error || face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+    {
+        cout << "FreeType ERROR: Could not find glyph outline for character "
+             << character << " (" << char(character) << ")" <<  endl;
+        return PackGlyph(MyGlyph());
+    }
+
+    // size the packed glyph from the outline, then convert directly into it
+    FT_Outline &outline = face->glyph->outline;
+    float em = face->units_per_EM;
+
+    SegmentCounter counter;
+    WalkOutline(outline, em, counter);
+
+    PackedGlyphBuilder builder(face->glyph->advance.x / em, counter);
+    WalkOutline(outline, em, builder);
+    return builder.Finish();
+}
+
+// --------------------------------------------------------------------------
@@ -18,12 +18,15 @@
 #ifndef GLYPHEXTRACTOR_H
 #define GLYPHEXTRACTOR_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include "FontRegistry.h"
+
 // --------------------------------------------------------------------------
 // DATA STRUCTURES: Segment, Contour, and Glyph
 
@@ -57,27 +60,138 @@ struct MyGlyph
     {}
 };
 
+// --------------------------------------------------------------------------
+// DATA STRUCTURES: Packed Glyph
+//
+// A packed glyph holds the same outline as a MyGlyph in one contiguous block
+// of memory. Segments are bucketed by degree into tightly packed arrays of
+// (x,y) control points, so lines take 2 points, quadratics 3 and cubics 4,
+// and each bucket can be copied straight into a vertex buffer. The block is
+// laid out as follows, all offsets relative to the start of the block:
+//  - a MyPackedGlyphHeader
+//  - (contours + 1) x 3 unsigned ints: the first line, quadratic and cubic
+//    segment of each contour, with a final entry marking the end
+//  - line, then quadratic, then cubic control points, as float x,y pairs
+//  - one byte per segment giving its degree in original outline order,
+//    padded to a multiple of 4 bytes
+// Copies of a packed glyph share the block rather than duplicating it.
+
+struct MyPackedGlyphHeader
+{
+    // advance width to next glyph, in EM units
+    float advance;
+
+    unsigned int contourCount;
+
+    // number of line, quadratic and cubic segments (indexed by degree - 1)
+    unsigned int segmentCount[3];
+};
+
+class MyPackedGlyph
+{
+    // keeps the block alive; it may be a heap allocation or a mapped file
+    std::shared_ptr<const void> m_owner;
+    const MyPackedGlyphHeader *m_header;
+
+    const unsigned int *ContourTable() const;
+
+public:
+    MyPackedGlyph();
+    MyPackedGlyph(const std::shared_ptr<const void> &owner, const void *block);
+
+    // size in bytes of a block with the given numbers of contours and
+    // line, quadratic and cubic segments
+    static size_t BlockBytes(unsigned int contours, const unsigned int segments[3]);
+
+    bool Empty() const                      { return m_header == 0; }
+    const void *Data() const                { return m_header; }
+    size_t Bytes() const;
+
+    float Advance() const;
+    unsigned int ContourCount() const;
+
+    // number of segments of the given degree (1-3), or of all degrees
+    unsigned int SegmentCount(unsigned int degree) const;
+    unsigned int SegmentCount() const;
+
+    // control points of all segments of the given degree, as x,y pairs with
+    // (degree + 1) points per segment
+    const float *Points(unsigned int degree) const;
+
+    // index of the first segment of the given degree in contour c; passing
+    // c = ContourCount() gives the end of the last contour
+    unsigned int ContourBegin(unsigned int c, unsigned int degree) const;
+
+    // degree of every segment, in the order they appear in the outline
+    const unsigned char *Degrees() const;
+};
+
+// conversions between the packed and nested glyph representations;
+// segments of degree 0 (single points) are not stored in packed glyphs
+MyPackedGlyph PackGlyph(const MyGlyph &glyph);
+MyGlyph UnpackGlyph(const MyPackedGlyph &packed);
+
 // --------------------------------------------------------------------------
 // This class encapsulates functionality required to load a font file from
-// disk and retrieve glyph outlines for characters from the font.
+// disk and retrieve glyph outlines for characters from the font. Font files
+// are opened through the FontRegistry, so extractors for the same file share
+// a single face and loading a font a second time is cheap. Glyphs can also
+// be served from a precompiled GlyphPack, with or without the font file.
+
+class GlyphPack;
 
 class GlyphExtractor
 {
-    FT_Library  m_library;
+    FontHandle  m_font;
     FT_Face     m_face;
 
+    // precompiled glyphs, consulted before the font face
+    std::shared_ptr<const GlyphPack> m_pack;
+
+    // private faces used by worker threads in ExtractGlyphs, opened on demand
+    mutable std::vector<FontHandle> m_workerFaces;
+
     // private methods to print font/glyph info, for debugging
     void PrintFontInformation() const;
     void PrintGlyphInformation(int character) const;
 
+    // reads a glyph outline from the given face, bypassing the glyph cache
+    static MyPackedGlyph DecodeGlyph(FT_Face face, int character);
+
 public:
     GlyphExtractor();
 
     // call this method first to load a font file
     bool LoadFontFile(const std::string &filename);
 
-    // this method retrieves a (possibly composite) glyph for the given character
+    // loads a glyph pack (see GlyphPack.h); glyphs found in the pack are
+    // returned without decoding, so a pack can be used without a font file
+    bool LoadGlyphPack(const std::string &filename);
+
+    // every character code the loaded font file has a glyph for
+    std::vector<int> CharacterCodes() const;
+
+    // kerning pairs of the loaded glyph pack or font file
+    const KerningTable &Kerning() const;
+
+    // this method retrieves a (possibly composite) glyph for the given character;
+    // glyphs that were extracted before are returned from the GlyphCache
     MyGlyph ExtractGlyph(int character) const;
+
+    // same as ExtractGlyph, but returns the outline in packed form without
+    // going through the nested contour representation
+    MyPackedGlyph ExtractPackedGlyph(int character) const;
+
+    // advance widths for a run of characters, written to advances, without
+    // loading any outlines; returns the total width of the run
+    float ExtractAdvances(const int *characters, size_t count, float *advances) const;
+    float ExtractAdvance(int character) const;
+
+    // retrieves glyphs for a run of characters, decoding the ones that are
+    // not cached yet in parallel on the shared ThreadPool, with one face per
+    // worker thread; results are returned in the same order as the input
+    std::vector<MyGlyph> ExtractGlyphs(const int *characters, size_t count) const;
+    std::vector<MyPackedGlyph> ExtractPackedGlyphs(const int *characters, size_t count) const;
 };
 
 // --------------------------------------------------------------------------
@@ -0,0 +1,276 @@
+// ==========================================================================
+// Glyph Pack Files
+//
+// See GlyphPack.h for an overview of the glyph pack format.
+// ==========================================================================
+
+#include "GlyphPack.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // checks that a glyph's contour table runs from 0 to the segment count
+    // of each degree without going backwards, and that the degree bytes of
+    // each contour agree with it, so nothing reading the glyph can step
+    // outside its block
+    bool CheckContours(const MyPackedGlyph &glyph)
+    {
+        const unsigned char *degrees = glyph.Degrees();
+        for (unsigned int d = 1; d <= 3; ++d)
+        {
+            if (glyph.ContourBegin(0, d) != 0
+                || glyph.ContourBegin(glyph.ContourCount(), d) != glyph.SegmentCount(d))
+                return false;
+        }
+
+        for (unsigned int c = 0; c < glyph.ContourCount(); ++c)
+        {
+            unsigned int counts[3];
+            for (unsigned int d = 1; d <= 3; ++d)
+            {
+                if (glyph.ContourBegin(c+1, d) < glyph.ContourBegin(c, d))
+                    return false;
+                counts[d-1] = glyph.ContourBegin(c+1, d) - glyph.ContourBegin(c, d);
+            }
+
+            unsigned int count = counts[0] + counts[1] + counts[2];
+            for (unsigned int s = 0; s < count; ++s)
+            {
+                unsigned int d = *degrees++;
+                if (d < 1 || d > 3 || counts[d-1]-- == 0)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // checks that an entry's block lies within the file, that its counts
+    // could fit in it and add up to its size, and that its contours are
+    // consistent with its segments
+    bool CheckBlock(const MappedFileHandle &file, const GlyphPackEntry &entry)
+    {
+        size_t size = file->Size();
+        if (entry.offset % 4 != 0 || entry.offset > size
+            || entry.bytes > size - entry.offset
+            || entry.bytes < sizeof(MyPackedGlyphHeader))
+            return false;
+
+        // every contour takes 3 words and every segment at least 2 points,
+        // so larger counts are corrupt whatever BlockBytes makes of them
+        const void *block = file->Data() + entry.offset;
+        const MyPackedGlyphHeader *header = static_cast<const MyPackedGlyphHeader *>(block);
+        if (header->contourCount > entry.bytes / (3 * sizeof(unsigned int)))
+            return false;
+        for (unsigned int d = 1; d <= 3; ++d)
+        {
+            if (header->segmentCount[d-1] > entry.bytes / ((d + 1) * 2 * sizeof(float)))
+                return false;
+        }
+        if (MyPackedGlyph::BlockBytes(header->contourCount, header->segmentCount) != entry.bytes)
+            return false;
+
+        return CheckContours(MyPackedGlyph(file, block));
+    }
+}
+
+// --------------------------------------------------------------------------
+
+GlyphPack::GlyphPack()
+    : m_header(0), m_entries(0)
+{}
+
+bool GlyphPack::Open(const string &filename)
+{
+    m_header = 0;
+    m_entries = 0;
+    m_kerning.Clear();
+
+    m_file = MapFile(filename);
+    if (!m_file) return false;
+
+    const unsigned char *data = m_file->Data();
+    size_t size = m_file->Size();
+    const GlyphPackHeader *header = reinterpret_cast<const GlyphPackHeader *>(data);
+
+    // check the header, then that the index lies within the file, then
+    // every glyph block, so that glyphs can be served without checks
+    if (size < sizeof(GlyphPackHeader)
+        || memcmp(header->magic, GLYPH_PACK_MAGIC, 4) != 0
+        || header->byteOrder != GLYPH_PACK_BYTE_ORDER)
+    {
+        cout << "GlyphPack ERROR: " << filename << " is not a glyph pack for this machine" << endl;
+        m_file.reset();
+        return false;
+    }
+    if (header->version != GLYPH_PACK_VERSION)
+    {
+        cout << "GlyphPack ERROR: " << filename << " has version " << header->version
+             << ", expected " << GLYPH_PACK_VERSION << endl;
+        m_file.reset();
+        return false;
+    }
+    if (header->fileSize != size || header->indexOffset % 4 != 0
+        || header->indexOffset > size
+        || header->glyphCount > (size - header->indexOffset) / sizeof(GlyphPackEntry)
+        || header->kerningOffset % 4 != 0 || header->kerningOffset > size
+        || header->kerningCount > (size - header->kerningOffset) / sizeof(KerningPair))
+    {
+        cout << "GlyphPack ERROR: " << filename << " is truncated or corrupt" << endl;
+        m_file.reset();
+        return false;
+    }
+
+    const GlyphPackEntry *entries = reinterpret_cast<const GlyphPackEntry *>(data + header->indexOffset);
+    for (unsigned int i = 0; i < header->glyphCount; ++i)
+    {
+        if (!CheckBlock(m_file, entries[i]))
+        {
+            cout << "GlyphPack ERROR: " << filename << " has a corrupt glyph for character "
+                 << entries[i].character << endl;
+            m_file.reset();
+            return false;
+        }
+    }
+
+    m_header = header;
+    m_entries = entries;
+
+    m_kerning.Build(reinterpret_cast<const KerningPair *>(data + header->kerningOffset),
+                    header->kerningCount);
+    return true;
+}
+
+// --------------------------------------------------------------------------
+
+const GlyphPackEntry *GlyphPack::FindEntry(int character) const
+{
+    if (!m_header) return 0;
+
+    const GlyphPackEntry *begin = m_entries;
+    const GlyphPackEntry *end = m_entries + m_header->glyphCount;
+
+    // binary search of the sorted index
+    while (begin < end)
+    {
+        const GlyphPackEntry *mid = begin + (end - begin) / 2;
+        if (mid->character < character) begin = mid + 1;
+        else end = mid;
+    }
+    if (begin == m_entries + m_header->glyphCount || begin->character != character)
+        return 0;
+    return begin;
+}
+
+bool GlyphPack::Find(int character, MyPackedGlyph &glyph) const
+{
+    const GlyphPackEntry *entry = FindEntry(character);
+    if (!entry) return false;
+
+    // Open checked every block
+    glyph = MyPackedGlyph(m_file, m_file->Data() + entry->offset);
+    return true;
+}
+
+bool GlyphPack::FindAdvance(int character, float &advance) const
+{
+    const GlyphPackEntry *entry = FindEntry(character);
+    if (!entry) return false;
+
+    advance = entry->advance;
+    return true;
+}
+
+// --------------------------------------------------------------------------
+
+GlyphPackHandle LoadGlyphPack(const string &filename)
+{
+    // packs stay loaded for as long as someone holds a handle
+    static map<string, weak_ptr<const GlyphPack> > packs;
+
+    GlyphPackHandle pack = packs[filename].lock();
+    if (pack) return pack;
+
+    shared_ptr<GlyphPack> loaded(new GlyphPack());
+    if (!loaded->Open(filename))
+        return GlyphPackHandle();
+
+    packs[filename] = loaded;
+    return loaded;
+}
+
+// --------------------------------------------------------------------------
+
+bool WriteGlyphPack(const string &filename, const vector<int> &characters,
+                    const vector<MyPackedGlyph> &glyphs,
+                    const vector<KerningPair> &kerning)
+{
+    if (characters.size() != glyphs.size()) {
+        cout << "GlyphPack ERROR: character and glyph counts differ" << endl;
+        return false;
+    }
+
+    // write entries in character order
+    vector<size_t> order(characters.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    sort(order.begin(), order.end(),
+         [&](size_t a, size_t b) { return characters[a] < characters[b]; });
+
+    // skip duplicate characters and glyphs that failed to load
+    vector<size_t> kept;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (glyphs[order[i]].Empty()) continue;
+        if (!kept.empty() && characters[kept.back()] == characters[order[i]]) continue;
+        kept.push_back(order[i]);
+    }
+
+    GlyphPackHeader header;
+    memcpy(header.magic, GLYPH_PACK_MAGIC, 4);
+    header.version = GLYPH_PACK_VERSION;
+    header.byteOrder = GLYPH_PACK_BYTE_ORDER;
+    header.glyphCount = unsigned(kept.size());
+    header.indexOffset = sizeof(GlyphPackHeader);
+    header.kerningCount = unsigned(kerning.size());
+    header.kerningOffset = unsigned(header.indexOffset + kept.size() * sizeof(GlyphPackEntry));
+
+    // glyph blocks follow the kerning pairs; block sizes are multiples of 4
+    // bytes, so every block stays aligned
+    vector<GlyphPackEntry> index(kept.size());
+    size_t offset = header.kerningOffset + kerning.size() * sizeof(KerningPair);
+    for (size_t i = 0; i < kept.size(); ++i)
+    {
+        const MyPackedGlyph &glyph = glyphs[kept[i]];
+        index[i].character = characters[kept[i]];
+        index[i].advance = glyph.Advance();
+        index[i].offset = unsigned(offset);
+        index[i].bytes = unsigned(glyph.Bytes());
+        offset += index[i].bytes;
+    }
+    header.fileSize = unsigned(offset);
+
+    ofstream output(filename.c_str(), ios::binary);
+    if (!output) {
+        cout << "GlyphPack ERROR: Could not write " << filename << endl;
+        return false;
+    }
+
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!index.empty())
+        output.write(reinterpret_cast<const char *>(&index[0]), index.size() * sizeof(GlyphPackEntry));
+    if (!kerning.empty())
+        output.write(reinterpret_cast<const char *>(&kerning[0]), kerning.size() * sizeof(KerningPair));
+    for (size_t i = 0; i < kept.size(); ++i)
+        output.write(static_cast<const char *>(glyphs[kept[i]].Data()), glyphs[kept[i]].Bytes());
+
+    return bool(output);
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,105 @@
+// ==========================================================================
+// Glyph Pack Files
+//
+// A glyph pack is a precompiled, memory-mappable file holding every glyph of
+// a font already converted to EM units, so that a program can start drawing
+// text without parsing the font through FreeType. The file is laid out as:
+//  - a GlyphPackHeader
+//  - an index of GlyphPackEntry records, sorted by character code
+//  - the font's KerningPair records
+//  - one MyPackedGlyph block per entry, each aligned to 4 bytes
+// All offsets are in bytes from the start of the file, and all values are
+// stored in the byte order of the machine that wrote the pack; packs from a
+// machine of the other byte order are rejected when loading.
+//
+// Packs are generated with the glyphpack tool (make packs).
+// ==========================================================================
+#ifndef GLYPHPACK_H
+#define GLYPHPACK_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GlyphExtractor.h"
+#include "Kerning.h"
+#include "MappedFile.h"
+
+// --------------------------------------------------------------------------
+// FILE FORMAT
+
+#define GLYPH_PACK_MAGIC        "GPAK"
+#define GLYPH_PACK_VERSION      2
+#define GLYPH_PACK_BYTE_ORDER   0x01020304u
+
+struct GlyphPackHeader
+{
+    char            magic[4];
+    unsigned int    version;
+    unsigned int    byteOrder;
+    unsigned int    glyphCount;
+    unsigned int    indexOffset;
+    unsigned int    kerningCount;
+    unsigned int    kerningOffset;
+    unsigned int    fileSize;
+};
+
+struct GlyphPackEntry
+{
+    int             character;
+    float           advance;        // same as the block's advance, for layout
+    unsigned int    offset;         // of the glyph's MyPackedGlyph block
+    unsigned int    bytes;
+};
+
+// --------------------------------------------------------------------------
+// A loaded glyph pack. Every glyph block is checked once, when the pack is
+// opened, and glyphs are then served straight out of the file mapping; each
+// returned MyPackedGlyph keeps the mapping alive while it is in use.
+
+class GlyphPack
+{
+    MappedFileHandle        m_file;
+    const GlyphPackHeader  *m_header;
+    const GlyphPackEntry   *m_entries;
+    KerningTable            m_kerning;
+
+    const GlyphPackEntry *FindEntry(int character) const;
+
+public:
+    GlyphPack();
+
+    // maps and validates a pack file, printing an error if it is not usable
+    bool Open(const std::string &filename);
+
+    size_t Size() const     { return m_header ? m_header->glyphCount : 0; }
+
+    // the index, sorted by character code
+    const GlyphPackEntry *Entries() const   { return m_entries; }
+
+    // sets glyph to the packed glyph for a character and returns true, or
+    // returns false if the pack does not contain it
+    bool Find(int character, MyPackedGlyph &glyph) const;
+
+    // sets advance for a character without touching its outline
+    bool FindAdvance(int character, float &advance) const;
+
+    // kerning pairs stored in the pack
+    const KerningTable &Kerning() const     { return m_kerning; }
+};
+
+typedef std::shared_ptr<const GlyphPack> GlyphPackHandle;
+
+// returns a shared handle to the pack in the given file, reusing the pack if
+// it is already loaded; returns an empty handle if it could not be loaded
+GlyphPackHandle LoadGlyphPack(const std::string &filename);
+
+// writes a pack holding the given glyphs and kerning pairs; characters need
+// not be sorted
+bool WriteGlyphPack(const std::string &filename,
+                    const std::vector<int> &characters,
+                    const std::vector<MyPackedGlyph> &glyphs,
+                    const std::vector<KerningPair> &kerning);
+
+// --------------------------------------------------------------------------
+#endif // GLYPHPACK_H
@@ -0,0 +1,117 @@
+// ==========================================================================
+// Indexed Patches
+//
+// See IndexedPatches.h for an overview of indexed patches.
+// ==========================================================================
+
+#include "IndexedPatches.h"
+#include <algorithm>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+void IndexedPatches::Clear()
+{
+    m_xy.clear();
+    m_rgb.clear();
+    m_indices.clear();
+    m_endpoints.clear();
+}
+
+unsigned int IndexedPatches::AddPoint(const float *xy, const float *rgb)
+{
+    unsigned int index = unsigned(m_xy.size() / 2);
+    m_xy.insert(m_xy.end(), xy, xy + 2);
+    m_rgb.insert(m_rgb.end(), rgb, rgb + 3);
+    return index;
+}
+
+bool IndexedPatches::EndpointKey::operator<(const EndpointKey &other) const
+{
+    return lexicographical_compare(values, values + 5, other.values, other.values + 5);
+}
+
+unsigned int IndexedPatches::AddEndpoint(const float *xy, const float *rgb)
+{
+    EndpointKey key = { { xy[0], xy[1], rgb[0], rgb[1], rgb[2] } };
+
+    map<EndpointKey, unsigned int>::iterator found = m_endpoints.find(key);
+    if (found != m_endpoints.end()) return found->second;
+
+    unsigned int index = AddPoint(xy, rgb);
+    m_endpoints[key] = index;
+    return index;
+}
+
+void IndexedPatches::AddSegment(unsigned int degree, const float *xy, const float *rgb)
+{
+    switch (degree)
+    {
+    case 1:
+    {
+        unsigned int a = AddEndpoint(xy, rgb);
+        unsigned int b = AddEndpoint(xy + 2, rgb + 3);
+        unsigned int patch[4] = { a, a, b, b };
+        m_indices.insert(m_indices.end(), patch, patch + 4);
+        break;
+    }
+    case 2:
+    {
+        unsigned int first = AddEndpoint(xy, rgb);
+        unsigned int middle = AddPoint(xy + 2, rgb + 3);
+        unsigned int last = AddEndpoint(xy + 4, rgb + 6);
+        unsigned int patch[4] = { first, middle, middle, last };
+        m_indices.insert(m_indices.end(), patch, patch + 4);
+        break;
+    }
+    case 3:
+    {
+        // inner points are never shared, so Pack can move one on its own
+        unsigned int first = AddEndpoint(xy, rgb);
+        unsigned int inner1 = AddPoint(xy + 2, rgb + 3);
+        unsigned int inner2 = AddPoint(xy + 4, rgb + 6);
+        unsigned int last = AddEndpoint(xy + 6, rgb + 9);
+        unsigned int patch[4] = { first, inner1, inner2, last };
+        m_indices.insert(m_indices.end(), patch, patch + 4);
+        break;
+    }
+    }
+}
+
+void IndexedPatches::AddSegments(unsigned int degree, const float *xy, const float *rgb,
+                                 size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        AddSegment(degree, xy + 2 * (degree + 1) * i, rgb + 3 * (degree + 1) * i);
+}
+
+float IndexedPatches::Pack(vector<PackedVertex> &vertices) const
+{
+    size_t count = PointCount();
+    vertices.resize(count);
+    if (count == 0) return 1.f;
+
+    float scale = PositionScale(&m_xy[0], count);
+    PackVertices(&m_xy[0], &m_rgb[0], count, scale, &vertices[0]);
+
+    for (size_t i = 0; i < m_indices.size(); i += 4)
+    {
+        // lines repeat their first point and quadratics their middle one
+        const unsigned int *patch = &m_indices[i];
+        if (patch[0] == patch[1] || patch[1] == patch[2]) continue;
+
+        // the shader takes coincident inner points for a quadratic. That
+        // only changes the curve if neither end point is there too
+        const PackedVertex &first = vertices[patch[0]];
+        const PackedVertex &inner1 = vertices[patch[1]];
+        PackedVertex &inner2 = vertices[patch[2]];
+        const PackedVertex &last = vertices[patch[3]];
+        if (SamePosition(inner1, inner2) && !SamePosition(first, inner1)
+            && !SamePosition(last, inner2))
+            inner2.x += inner2.x < PACKED_POSITION_MAX ? 1 : -1;
+    }
+    return scale;
+}
+
+// --------------------------------------------------------------------------
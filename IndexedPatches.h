@@ -0,0 +1,77 @@
+// ==========================================================================
+// Indexed Patches
+//
+// Curves are drawn as cubic patches of 4 control points. Rather than storing
+// every patch's points one after the other, IndexedPatches stores each
+// control point once and describes a patch by 4 indices into the points:
+//  - end points are shared: a segment that ends where another starts, in
+//    the same colour, uses the same point, so each joint of a contour is
+//    stored once instead of twice
+//  - lines and quadratics are not degree-elevated on the CPU. A line from
+//    A to B is the patch A, A, B, B and a quadratic P0, P1, P2 is the patch
+//    P0, P1, P1, P2; the tessellation control shader recognizes the repeated
+//    points and elevates them, so a line needs one new point and a
+//    quadratic two instead of three
+//  - the shader sees packed positions (see VertexFormat.h), so a cubic
+//    whose two inner points pack to the same position would look like a
+//    quadratic. Pack moves one of them a step of the packed grid, which
+//    moves the curve by less than half a step, less than packing itself
+// Inner control points are never shaded, so their colours are kept only to
+// give every point one.
+// ==========================================================================
+#ifndef INDEXEDPATCHES_H
+#define INDEXEDPATCHES_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "VertexFormat.h"
+
+// --------------------------------------------------------------------------
+
+class IndexedPatches
+{
+    // x,y and r,g,b of every point, and 4 point indices per patch
+    std::vector<float>          m_xy;
+    std::vector<float>          m_rgb;
+    std::vector<unsigned int>   m_indices;
+
+    // x,y and r,g,b of an end point, to find it again
+    struct EndpointKey
+    {
+        float   values[5];
+
+        bool operator<(const EndpointKey &other) const;
+    };
+
+    // index of the end point at each position and colour so far
+    std::map<EndpointKey, unsigned int> m_endpoints;
+
+    unsigned int AddPoint(const float *xy, const float *rgb);
+    unsigned int AddEndpoint(const float *xy, const float *rgb);
+
+public:
+    void Clear();
+
+    // adds one segment of degree 1 to 3 from its degree + 1 x,y control
+    // points and their r,g,b colours
+    void AddSegment(unsigned int degree, const float *xy, const float *rgb);
+
+    // the same for count segments stored one after the other
+    void AddSegments(unsigned int degree, const float *xy, const float *rgb, size_t count);
+
+    // packs every point into vertices, as PackVertices does with the
+    // position scale of all the points, which it returns
+    float Pack(std::vector<PackedVertex> &vertices) const;
+
+    size_t PointCount() const       { return m_xy.size() / 2; }
+    size_t IndexCount() const       { return m_indices.size(); }
+
+    const float *Points() const                 { return m_xy.empty() ? 0 : &m_xy[0]; }
+    const float *Colours() const                { return m_rgb.empty() ? 0 : &m_rgb[0]; }
+    const unsigned int *Indices() const         { return m_indices.empty() ? 0 : &m_indices[0]; }
+};
+
+// --------------------------------------------------------------------------
+#endif // INDEXEDPATCHES_H
@@ -0,0 +1,105 @@
+// ==========================================================================
+// Kerning Pair Tables
+//  - requires the FreeType development libraries: http://www.freetype.org
+//
+// See Kerning.h for an overview of kerning tables.
+// ==========================================================================
+
+#include "Kerning.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+KerningTable::KerningTable()
+{}
+
+void KerningTable::Clear()
+{
+    m_dense.clear();
+    m_sparse.clear();
+}
+
+void KerningTable::Add(int left, int right, float adjustment)
+{
+    if (adjustment == 0.f) return;
+
+    if (IsDense(left) && IsDense(right))
+    {
+        if (m_dense.empty()) m_dense.assign(DENSE_COUNT * DENSE_COUNT, 0.f);
+        m_dense[(left - DENSE_FIRST) * DENSE_COUNT + (right - DENSE_FIRST)] = adjustment;
+    }
+    else
+        m_sparse[Key(left, right)] = adjustment;
+}
+
+// --------------------------------------------------------------------------
+
+void KerningTable::Build(FT_Face face)
+{
+    Clear();
+    if (!face || !FT_HAS_KERNING(face)) return;
+
+    // collect the character map once, with glyph indices
+    vector<int> characters;
+    vector<FT_UInt> indices;
+    FT_UInt index = 0;
+    FT_ULong character = FT_Get_First_Char(face, &index);
+    while (index != 0)
+    {
+        characters.push_back(int(character));
+        indices.push_back(index);
+        character = FT_Get_Next_Char(face, character, &index);
+    }
+
+    // unscaled kerning is in font units, like the glyph outlines
+    float em = face->units_per_EM;
+    for (size_t a = 0; a < characters.size(); ++a)
+    {
+        for (size_t b = 0; b < characters.size(); ++b)
+        {
+            FT_Vector kerning;
+            if (FT_Get_Kerning(face, indices[a], indices[b], FT_KERNING_UNSCALED, &kerning) == 0)
+                Add(characters[a], characters[b], kerning.x / em);
+        }
+    }
+}
+
+void KerningTable::Build(const KerningPair *pairs, size_t count)
+{
+    Clear();
+    for (size_t i = 0; i < count; ++i)
+        Add(pairs[i].left, pairs[i].right, pairs[i].adjustment);
+}
+
+// --------------------------------------------------------------------------
+
+vector<KerningPair> KerningTable::Pairs() const
+{
+    vector<KerningPair> pairs;
+
+    for (size_t i = 0; i < m_dense.size(); ++i)
+    {
+        if (m_dense[i] == 0.f) continue;
+
+        KerningPair pair;
+        pair.left = DENSE_FIRST + int(i) / DENSE_COUNT;
+        pair.right = DENSE_FIRST + int(i) % DENSE_COUNT;
+        pair.adjustment = m_dense[i];
+        pairs.push_back(pair);
+    }
+
+    unordered_map<unsigned long long, float>::const_iterator it;
+    for (it = m_sparse.begin(); it != m_sparse.end(); ++it)
+    {
+        KerningPair pair;
+        pair.left = int(it->first >> 32);
+        pair.right = int(it->first & 0xffffffffu);
+        pair.adjustment = it->second;
+        pairs.push_back(pair);
+    }
+
+    return pairs;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+// ==========================================================================
+// Kerning Pair Tables
+//  - requires the FreeType development libraries: http://www.freetype.org
+//
+// A KerningTable holds every kerning adjustment of a font, looked up once
+// when the font is loaded, so that laying out text needs no FreeType calls.
+//  - Pairs of printable ASCII characters live in a dense array
+//  - All other pairs with a nonzero adjustment live in a hash table
+// Adjustments are in EM units, to be added to the advance of the left
+// character when it is followed by the right one.
+// ==========================================================================
+#ifndef KERNING_H
+#define KERNING_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// --------------------------------------------------------------------------
+
+struct KerningPair
+{
+    int     left;
+    int     right;
+    float   adjustment;
+};
+
+class KerningTable
+{
+    // characters covered by the dense table
+    static const int DENSE_FIRST = 32;
+    static const int DENSE_COUNT = 95;
+
+    std::vector<float> m_dense;
+    std::unordered_map<unsigned long long, float> m_sparse;
+
+    static bool IsDense(int c)
+    { return unsigned(c - DENSE_FIRST) < unsigned(DENSE_COUNT); }
+
+    static unsigned long long Key(int left, int right)
+    { return (static_cast<unsigned long long>(unsigned(left)) << 32) | unsigned(right); }
+
+    void Add(int left, int right, float adjustment);
+
+public:
+    KerningTable();
+
+    // fills the table with the kerning of every pair of characters in the
+    // face's character map; leaves it empty if the face has no kerning
+    void Build(FT_Face face);
+
+    // fills the table from a list of pairs, as stored in a glyph pack
+    void Build(const KerningPair *pairs, size_t count);
+
+    void Clear();
+    bool Empty() const      { return m_dense.empty() && m_sparse.empty(); }
+
+    // every nonzero pair in the table
+    std::vector<KerningPair> Pairs() const;
+
+    float Adjustment(int left, int right) const
+    {
+        if (IsDense(left) && IsDense(right)) {
+            if (m_dense.empty()) return 0.f;
+            return m_dense[(left - DENSE_FIRST) * DENSE_COUNT + (right - DENSE_FIRST)];
+        }
+        if (m_sparse.empty()) return 0.f;
+
+        std::unordered_map<unsigned long long, float>::const_iterator it =
+            m_sparse.find(Key(left, right));
+        return it == m_sparse.end() ? 0.f : it->second;
+    }
+};
+
+// --------------------------------------------------------------------------
+#endif // KERNING_H
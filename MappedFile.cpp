@@ -0,0 +1,131 @@
+// ==========================================================================
+// Read-Only Memory-Mapped Files
+//
+// See MappedFile.h for an overview of mapped files.
+// ==========================================================================
+
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+MappedFile::MappedFile()
+    : m_data(0), m_size(0)
+#ifdef _WIN32
+    , m_file(0), m_mapping(0)
+#endif
+{}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+// --------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const string &filename)
+{
+    Close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        cout << "ERROR: Could not open file " << filename << endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    HANDLE mapping = 0;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+
+    if (!data) {
+        cout << "ERROR: Could not map file " << filename << endl;
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const unsigned char *>(data);
+    m_size = size_t(size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+    m_data = 0;
+    m_size = 0;
+    m_mapping = 0;
+    m_file = 0;
+}
+
+#else
+
+bool MappedFile::Open(const string &filename)
+{
+    Close();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cout << "ERROR: Could not open file " << filename << endl;
+        return false;
+    }
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(0, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        cout << "ERROR: Could not map file " << filename << endl;
+        return false;
+    }
+
+    m_data = static_cast<const unsigned char *>(data);
+    m_size = size_t(info.st_size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data) munmap(const_cast<unsigned char *>(m_data), m_size);
+    m_data = 0;
+    m_size = 0;
+}
+
+#endif
+
+// --------------------------------------------------------------------------
+
+MappedFileHandle MapFile(const string &filename)
+{
+    shared_ptr<MappedFile> file(new MappedFile());
+    if (!file->Open(filename))
+        return MappedFileHandle();
+    return file;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,49 @@
+// ==========================================================================
+// Read-Only Memory-Mapped Files
+//
+// A MappedFile maps a whole file into memory read-only, so that its contents
+// are paged in on demand instead of being read through buffered file I/O.
+// Font faces and glyph packs share mappings through MappedFileHandle.
+// ==========================================================================
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <memory>
+#include <string>
+
+// --------------------------------------------------------------------------
+
+class MappedFile
+{
+    const unsigned char *m_data;
+    size_t  m_size;
+
+#ifdef _WIN32
+    void   *m_file;
+    void   *m_mapping;
+#endif
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // maps the given file, replacing any previous mapping; returns false and
+    // prints an error if the file could not be mapped
+    bool Open(const std::string &filename);
+    void Close();
+
+    bool IsOpen() const                     { return m_data != 0; }
+    const unsigned char *Data() const       { return m_data; }
+    size_t Size() const                     { return m_size; }
+};
+
+typedef std::shared_ptr<const MappedFile> MappedFileHandle;
+
+// maps a file and returns a shared handle to it, or an empty handle on failure
+MappedFileHandle MapFile(const std::string &filename);
+
+// --------------------------------------------------------------------------
+#endif // MAPPEDFILE_H
@@ -0,0 +1,126 @@
+// ==========================================================================
+// Render Statistics
+//
+// See RenderStats.h for an overview of render statistics.
+// ==========================================================================
+
+#include "RenderStats.h"
+#include <iostream>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+RenderStats::RenderStats()
+    : m_inFrame(false)
+{
+    Reset();
+}
+
+void RenderStats::Reset()
+{
+    m_frames = 0;
+    m_drawCalls = 0;
+    m_patches = 0;
+    m_glCalls = 0;
+    m_seconds = 0.0;
+    m_uploads = 0;
+    m_uploadedBytes = 0;
+    m_allocations = 0;
+    m_skippedFrames = 0;
+    m_resetTime = Clock::now();
+    m_resetClock = clock();
+    m_frameDrawCalls = 0;
+    m_framePatches = 0;
+    m_frameGLCalls = 0;
+}
+
+// --------------------------------------------------------------------------
+
+void RenderStats::BeginFrame()
+{
+    m_frameStart = Clock::now();
+    m_frameDrawCalls = 0;
+    m_framePatches = 0;
+    m_frameGLCalls = 0;
+    m_inFrame = true;
+}
+
+void RenderStats::EndFrame()
+{
+    if (!m_inFrame) return;
+
+    chrono::duration<double> elapsed = Clock::now() - m_frameStart;
+    m_seconds += elapsed.count();
+    m_drawCalls += m_frameDrawCalls;
+    m_patches += m_framePatches;
+    m_glCalls += m_frameGLCalls;
+    ++m_frames;
+    m_inFrame = false;
+}
+
+void RenderStats::CountDraw(unsigned long patches)
+{
+    ++m_frameDrawCalls;
+    m_framePatches += patches;
+}
+
+void RenderStats::CountGLCalls(unsigned long calls)
+{
+    if (m_inFrame) m_frameGLCalls += calls;
+}
+
+void RenderStats::CountUpload(unsigned long bytes, bool allocated)
+{
+    ++m_uploads;
+    m_uploadedBytes += bytes;
+    if (allocated) ++m_allocations;
+}
+
+void RenderStats::CountSkippedFrame()
+{
+    ++m_skippedFrames;
+}
+
+// --------------------------------------------------------------------------
+
+double RenderStats::DrawCallsPerFrame() const
+{
+    return m_frames ? double(m_drawCalls) / m_frames : 0.0;
+}
+
+double RenderStats::PatchesPerFrame() const
+{
+    return m_frames ? double(m_patches) / m_frames : 0.0;
+}
+
+double RenderStats::GLCallsPerFrame() const
+{
+    return m_frames ? double(m_glCalls) / m_frames : 0.0;
+}
+
+double RenderStats::MillisecondsPerFrame() const
+{
+    return m_frames ? 1000.0 * m_seconds / m_frames : 0.0;
+}
+
+double RenderStats::CpuShare() const
+{
+    chrono::duration<double> wall = Clock::now() - m_resetTime;
+    double cpu = double(clock() - m_resetClock) / CLOCKS_PER_SEC;
+    return wall.count() > 0.0 ? cpu / wall.count() : 0.0;
+}
+
+void RenderStats::Print() const
+{
+    cout << "Render stats over " << m_frames << " frames, " << m_skippedFrames << " skipped: "
+         << DrawCallsPerFrame() << " draw calls, "
+         << PatchesPerFrame() << " patches, "
+         << GLCallsPerFrame() << " GL calls, "
+         << MillisecondsPerFrame() << " ms per frame" << endl;
+    cout << "Buffer uploads: " << m_uploadedBytes << " bytes in " << m_uploads
+         << " uploads, " << m_allocations << " allocations" << endl;
+    cout << "CPU use: " << 100.0 * CpuShare() << "% of one core" << endl;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,90 @@
+// ==========================================================================
+// Render Statistics
+//
+// Counts the draw calls, patches and OpenGL calls made each frame and times frames,
+// so that changes to the drawing code can be measured before and after.
+//  - Bracket each frame with BeginFrame() and EndFrame()
+//  - Call CountDraw() next to every draw call, and CountGLCalls() next to
+//    every OpenGL call of the frame, draws included
+//  - Call CountUpload() next to every write into a GPU buffer; uploads are
+//    totalled whether or not they happen inside a frame
+//  - Call CountSkippedFrame() whenever the main loop wakes up and finds
+//    nothing to redraw
+// Figures are averaged over all frames since the last Reset(), which also
+// starts measuring how much of the elapsed time the process spent on a CPU.
+// ==========================================================================
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <chrono>
+#include <ctime>
+
+// --------------------------------------------------------------------------
+
+class RenderStats
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point   m_frameStart;
+    bool                m_inFrame;
+
+    unsigned long       m_frames;
+    unsigned long       m_drawCalls;
+    unsigned long       m_patches;
+    unsigned long       m_glCalls;
+    double              m_seconds;
+    unsigned long       m_uploads;
+    unsigned long       m_uploadedBytes;
+    unsigned long       m_allocations;
+    unsigned long       m_skippedFrames;
+
+    // wall clock and process CPU time at the last Reset()
+    Clock::time_point   m_resetTime;
+    std::clock_t        m_resetClock;
+
+    // counts for the frame in progress
+    unsigned long       m_frameDrawCalls;
+    unsigned long       m_framePatches;
+    unsigned long       m_frameGLCalls;
+
+public:
+    RenderStats();
+
+    void BeginFrame();
+    void EndFrame();
+
+    // records one draw call submitting the given number of patches,
+    // counting every instance
+    void CountDraw(unsigned long patches);
+
+    // records OpenGL calls; calls made outside a frame are not counted
+    void CountGLCalls(unsigned long calls = 1);
+
+    // records bytes copied into a GPU buffer, and whether the buffer's
+    // storage had to be allocated again to hold them
+    void CountUpload(unsigned long bytes, bool allocated);
+
+    void CountSkippedFrame();
+
+    void Reset();
+
+    unsigned long Frames() const    { return m_frames; }
+    double DrawCallsPerFrame() const;
+    double PatchesPerFrame() const;
+    double GLCallsPerFrame() const;
+    double MillisecondsPerFrame() const;
+    unsigned long Uploads() const       { return m_uploads; }
+    unsigned long UploadedBytes() const { return m_uploadedBytes; }
+    unsigned long Allocations() const   { return m_allocations; }
+    unsigned long SkippedFrames() const { return m_skippedFrames; }
+
+    // CPU time used by the whole process since the last Reset(), as a share
+    // of the wall clock time, where 1 is one core kept busy
+    double CpuShare() const;
+
+    // prints the averages to standard output
+    void Print() const;
+};
+
+// --------------------------------------------------------------------------
+#endif // RENDERSTATS_H
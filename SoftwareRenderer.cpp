@@ -0,0 +1,171 @@
+// ==========================================================================
+// Software Renderer
+//  - requires stb_image_write: https://github.com/nothings/stb
+//
+// See SoftwareRenderer.h for an overview of the software renderer.
+// ==========================================================================
+
+#include "SoftwareRenderer.h"
+#include "Bezier.h"
+#include "Tessellation.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+RenderUniforms::RenderUniforms()
+    : scale(1.f), pixelError(DEFAULT_PIXEL_ERROR)
+{
+    offset[0] = offset[1] = 0.f;
+    scrollOffset[0] = scrollOffset[1] = 0.f;
+}
+
+// --------------------------------------------------------------------------
+
+SoftwareRenderer::SoftwareRenderer(int width, int height)
+    : m_width(max(width, 1)), m_height(max(height, 1)),
+      m_pixels(size_t(m_width) * m_height * 4, 0)
+{}
+
+void SoftwareRenderer::Clear(float r, float g, float b)
+{
+    unsigned char clear[4] = {
+        (unsigned char)(min(max(r, 0.f), 1.f) * 255.f + 0.5f),
+        (unsigned char)(min(max(g, 0.f), 1.f) * 255.f + 0.5f),
+        (unsigned char)(min(max(b, 0.f), 1.f) * 255.f + 0.5f),
+        255
+    };
+
+    for (size_t i = 0; i < m_pixels.size(); i += 4)
+        copy(clear, clear + 4, &m_pixels[i]);
+}
+
+bool SoftwareRenderer::WritePNG(const string &filename) const
+{
+    if (!stbi_write_png(filename.c_str(), m_width, m_height, 4, &m_pixels[0], m_width * 4)) {
+        cout << "SoftwareRenderer ERROR: Could not write " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+// --------------------------------------------------------------------------
+
+void SoftwareRenderer::DrawLine(const float *a, const float *b,
+                                const float *colourA, const float *colourB)
+{
+    // clip the line to the window first, so that steps that run far off
+    // screen cost nothing (Liang-Barsky)
+    float dx = b[0] - a[0];
+    float dy = b[1] - a[1];
+    float t0 = 0.f, t1 = 1.f;
+    float p[4] = { -dx, dx, -dy, dy };
+    float q[4] = { a[0], m_width - a[0], a[1], m_height - a[1] };
+    for (int i = 0; i < 4; ++i)
+    {
+        if (p[i] == 0.f) {
+            if (q[i] < 0.f) return;
+            continue;
+        }
+        float t = q[i] / p[i];
+        if (p[i] < 0.f) t0 = max(t0, t);
+        else t1 = min(t1, t);
+    }
+    if (t0 > t1) return;
+
+    // step one pixel at a time along the longer axis, leaving off the last
+    // pixel so that consecutive steps do not draw their shared end twice
+    float length = max(fabs(dx), fabs(dy));
+    int first = int(ceil(t0 * length));
+    int last = int(ceil(t1 * length)) - 1;
+    if (length == 0.f) first = last = 0;
+
+    for (int i = first; i <= last; ++i)
+    {
+        float t = length > 0.f ? i / length : 0.f;
+        int x = int(floor(a[0] + t * dx));
+        int y = int(floor(a[1] + t * dy));
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height) continue;
+
+        // window coordinates run bottom to top, image rows top to bottom
+        unsigned char *pixel = &m_pixels[(size_t(m_height - 1 - y) * m_width + x) * 4];
+        for (int c = 0; c < 3; ++c)
+        {
+            float value = colourA[c] + t * (colourB[c] - colourA[c]);
+            pixel[c] = (unsigned char)(min(max(value, 0.f), 1.f) * 255.f + 0.5f);
+        }
+        pixel[3] = 255;
+    }
+}
+
+void SoftwareRenderer::DrawPatches(const float *xy, const float *rgb, size_t count,
+                                   const RenderUniforms &uniforms,
+                                   const float *instances, size_t instanceCount)
+{
+    const float origin[2] = { 0.f, 0.f };
+    if (!instances) {
+        instances = origin;
+        instanceCount = 1;
+    }
+
+    float points[2 * (MAX_TESSELLATION_LEVEL + 1)];
+
+    for (size_t n = 0; n < instanceCount; ++n)
+    {
+        const float *instance = instances + 2*n;
+        for (size_t s = 0; s < count; ++s)
+        {
+            // vertex.glsl, then clip space to window coordinates
+            float clip[8], window[8];
+            for (int i = 0; i < 4; ++i)
+            {
+                for (int axis = 0; axis < 2; ++axis)
+                    clip[2*i + axis] = uniforms.scale * (xy[8*s + 2*i + axis] + instance[axis])
+                                     + uniforms.offset[axis] + uniforms.scrollOffset[axis];
+                window[2*i]     = (clip[2*i] + 1.f) * 0.5f * m_width;
+                window[2*i + 1] = (clip[2*i + 1] + 1.f) * 0.5f * m_height;
+            }
+
+            // tessControl.glsl: skip patches whose hull misses clip space
+            float lower[2] = { clip[0], clip[1] }, upper[2] = { clip[0], clip[1] };
+            for (int i = 1; i < 4; ++i)
+            {
+                for (int axis = 0; axis < 2; ++axis) {
+                    lower[axis] = min(lower[axis], clip[2*i + axis]);
+                    upper[axis] = max(upper[axis], clip[2*i + axis]);
+                }
+            }
+            if (lower[0] > 1.f || lower[1] > 1.f || upper[0] < -1.f || upper[1] < -1.f)
+                continue;
+
+            // the level only depends on distances, which are the same in
+            // window coordinates as in pixels from the centre
+            int level = CubicTessellationLevel(window, uniforms.pixelError);
+            for (int j = 0; j <= level; ++j)
+                Bezier<3>::Evaluate(window, float(j) / level, points + 2*j);
+
+            // tessEval.glsl: colour blends between the end points
+            const float *start = rgb + 12*s;
+            const float *end = start + 9;
+            for (int j = 0; j < level; ++j)
+            {
+                float u0 = float(j) / level;
+                float u1 = float(j + 1) / level;
+                float colour0[3], colour1[3];
+                for (int c = 0; c < 3; ++c) {
+                    colour0[c] = start[c] + u0 * (end[c] - start[c]);
+                    colour1[c] = start[c] + u1 * (end[c] - start[c]);
+                }
+                DrawLine(points + 2*j, points + 2*j + 2, colour0, colour1);
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+// ==========================================================================
+// Software Renderer
+//
+// Draws the same cubic patch buffers as the OpenGL path into an RGBA image
+// in memory, so that scenes can be rendered and saved as PNGs on machines
+// without a GPU. Drawing follows the shader pipeline:
+//  - control points are placed with the offset, scale and scrollOffset
+//    uniforms and per-instance offsets, like vertex.glsl
+//  - patches entirely outside clip space are skipped, and the rest are
+//    split into as many steps as tessControl.glsl picks (see Tessellation.h)
+//  - steps are evaluated in the Bernstein form of tessEval.glsl and drawn as
+//    one-pixel lines, with colours blended between the patch's end points
+// Like the OpenGL path, lines are not anti-aliased.
+// ==========================================================================
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------------------
+
+// values of the shader uniforms used for drawing
+struct RenderUniforms
+{
+    float   offset[2];
+    float   scrollOffset[2];
+    float   scale;
+    float   pixelError;
+
+    RenderUniforms();
+};
+
+class SoftwareRenderer
+{
+    int                         m_width;
+    int                         m_height;
+    std::vector<unsigned char>  m_pixels;
+
+    // draws a line between two points in window coordinates, blending
+    // between two r,g,b colours
+    void DrawLine(const float *a, const float *b, const float *colourA, const float *colourB);
+
+public:
+    SoftwareRenderer(int width, int height);
+
+    int Width() const                       { return m_width; }
+    int Height() const                      { return m_height; }
+
+    // rows of RGBA pixels, top row first
+    const unsigned char *Pixels() const     { return &m_pixels[0]; }
+
+    void Clear(float r, float g, float b);
+
+    // Draws count patches of 4 x,y control points, with an r,g,b colour for
+    // each control point. The patches are drawn once for each of the
+    // instanceCount x,y offsets in instances, or once in place if instances
+    // is null.
+    void DrawPatches(const float *xy, const float *rgb, size_t count,
+                     const RenderUniforms &uniforms,
+                     const float *instances = 0, size_t instanceCount = 1);
+
+    bool WritePNG(const std::string &filename) const;
+};
+
+// --------------------------------------------------------------------------
+#endif // SOFTWARERENDERER_H
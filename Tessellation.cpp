@@ -0,0 +1,95 @@
+// ==========================================================================
+// Adaptive Tessellation Levels
+//
+// See Tessellation.h for an overview of adaptive tessellation levels.
+// ==========================================================================
+
+#include "Tessellation.h"
+#include "Bezier.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+void ClipToPixels(const float *clip, size_t count, float width, float height,
+                  float *pixels)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        pixels[2*i]     = clip[2*i]     * 0.5f * width;
+        pixels[2*i + 1] = clip[2*i + 1] * 0.5f * height;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int CubicTessellationLevel(const float *xy, float pixelError)
+{
+    // second differences of the control polygon bound the curvature
+    float ax = xy[0] - 2.f * xy[2] + xy[4];
+    float ay = xy[1] - 2.f * xy[3] + xy[5];
+    float bx = xy[2] - 2.f * xy[4] + xy[6];
+    float by = xy[3] - 2.f * xy[5] + xy[7];
+    float m = max(sqrt(ax*ax + ay*ay), sqrt(bx*bx + by*by));
+
+    // same expression and clamping as tessControl.glsl
+    float level = ceil(sqrt(0.75f * m / pixelError));
+    level = min(max(level, float(MIN_TESSELLATION_LEVEL)), float(MAX_TESSELLATION_LEVEL));
+    return int(level);
+}
+
+size_t TessellatedVertexCount(const float *xy, size_t count, float pixelError)
+{
+    // an isoline of n steps has n + 1 vertices
+    size_t vertices = 0;
+    for (size_t i = 0; i < count; ++i)
+        vertices += CubicTessellationLevel(xy + 8*i, pixelError) + 1;
+    return vertices;
+}
+
+// --------------------------------------------------------------------------
+
+void EvaluateCubic(const float *xy, float t, float *point)
+{
+    Bezier<3>::Evaluate(xy, t, point);
+}
+
+float CubicTessellationError(const float *xy, int level, int samples)
+{
+    float error = 0.f;
+
+    float start[2];
+    EvaluateCubic(xy, 0.f, start);
+    for (int step = 0; step < level; ++step)
+    {
+        float end[2];
+        EvaluateCubic(xy, float(step + 1) / level, end);
+
+        // distance from points along the curve to this step's chord
+        float dx = end[0] - start[0];
+        float dy = end[1] - start[1];
+        float length2 = dx*dx + dy*dy;
+        for (int i = 1; i < samples; ++i)
+        {
+            float point[2];
+            EvaluateCubic(xy, (step + float(i) / samples) / level, point);
+
+            float px = point[0] - start[0];
+            float py = point[1] - start[1];
+            float u = length2 > 0.f ? (px*dx + py*dy) / length2 : 0.f;
+            u = min(max(u, 0.f), 1.f);
+            float ex = px - u*dx;
+            float ey = py - u*dy;
+            error = max(error, sqrt(ex*ex + ey*ey));
+        }
+
+        start[0] = end[0];
+        start[1] = end[1];
+    }
+
+    return error;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,54 @@
+// ==========================================================================
+// Adaptive Tessellation Levels
+//
+// CPU reference for the tessellation levels chosen in tessControl.glsl, so
+// that vertex counts and flattening error can be checked without a GPU (the
+// tessbench tool does, over every glyph of the fonts in fonts/).
+// Every curve is drawn as a cubic patch, which the tessellator splits into
+// a polyline of evenly spaced parameter steps. The number of steps comes
+// from Wang's formula: a cubic with control points P0..P3 stays within
+// tolerance of a polyline of n steps when
+//
+//      n >= sqrt(3/4 * max(|P0 - 2 P1 + P2|, |P1 - 2 P2 + P3|) / tolerance)
+//
+// Straight patches (including degree-elevated lines) get a single step.
+// Points are x,y pairs in pixels, after the scale, offset and viewport
+// transforms of the shaders.
+// ==========================================================================
+#ifndef TESSELLATION_H
+#define TESSELLATION_H
+
+#include <cstddef>
+
+// --------------------------------------------------------------------------
+
+// limits of the outer tessellation level; 64 is the smallest maximum that
+// OpenGL implementations are allowed to support
+const int   MIN_TESSELLATION_LEVEL  = 1;
+const int   MAX_TESSELLATION_LEVEL  = 64;
+
+// default distance, in pixels, that a tessellated curve may stray from the
+// true curve
+const float DEFAULT_PIXEL_ERROR     = 0.25f;
+
+// converts count x,y points from clip space to pixels in a viewport of the
+// given size, as the tessellation control shader does
+void ClipToPixels(const float *clip, size_t count, float width, float height,
+                  float *pixels);
+
+// the outer tessellation level for one cubic patch of 4 points
+int CubicTessellationLevel(const float *xy, float pixelError);
+
+// the number of vertices the tessellator emits for count cubic patches
+// stored one after the other
+size_t TessellatedVertexCount(const float *xy, size_t count, float pixelError);
+
+// point on a cubic patch at parameter t
+void EvaluateCubic(const float *xy, float t, float *point);
+
+// largest distance between a cubic patch and the polyline of level steps
+// that the tessellator makes from it, measured at samples points per step
+float CubicTessellationError(const float *xy, int level, int samples = 16);
+
+// --------------------------------------------------------------------------
+#endif // TESSELLATION_H
@@ -0,0 +1,45 @@
+// ==========================================================================
+// Text Layout
+//
+// See TextLayout.h for an overview of text layout.
+// ==========================================================================
+
+#include "TextLayout.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+float LayoutText(const GlyphExtractor &extractor, const int *characters,
+                 size_t count, float *positions)
+{
+    if (count == 0) return 0.f;
+
+    // start from the plain advances, then accumulate them into positions
+    extractor.ExtractAdvances(characters, count, positions);
+
+    const KerningTable &kerning = extractor.Kerning();
+    float pen = 0.f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float advance = positions[i];
+        if (i + 1 < count && !kerning.Empty())
+            advance += kerning.Adjustment(characters[i], characters[i+1]);
+
+        positions[i] = pen;
+        pen += advance;
+    }
+    return pen;
+}
+
+float LayoutText(const GlyphExtractor &extractor, const string &text,
+                 vector<float> &positions)
+{
+    vector<int> characters(text.begin(), text.end());
+    positions.resize(text.size());
+    if (text.empty()) return 0.f;
+
+    return LayoutText(extractor, &characters[0], text.size(), &positions[0]);
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,30 @@
+// ==========================================================================
+// Text Layout
+//
+// Places a run of characters along a baseline. Each character's pen position
+// is the sum of the advances before it, adjusted by the kerning between each
+// pair of neighbouring characters. Advances and kerning both come from
+// precomputed tables (see GlyphExtractor::ExtractAdvances and Kerning.h), so
+// laying out text makes no FreeType calls.
+// ==========================================================================
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <string>
+#include <vector>
+
+#include "GlyphExtractor.h"
+
+// --------------------------------------------------------------------------
+
+// writes the pen position of every character, in EM units from the start of
+// the run, to positions and returns the total width of the run
+float LayoutText(const GlyphExtractor &extractor, const int *characters,
+                 size_t count, float *positions);
+
+// convenience form for a string of 8-bit characters
+float LayoutText(const GlyphExtractor &extractor, const std::string &text,
+                 std::vector<float> &positions);
+
+// --------------------------------------------------------------------------
+#endif // TEXTLAYOUT_H
@@ -0,0 +1,116 @@
+// ==========================================================================
+// Worker Thread Pool
+//
+// See ThreadPool.h for an overview of the thread pool.
+// ==========================================================================
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(unsigned int workers)
+    : m_task(0), m_count(0), m_grain(1), m_next(0),
+      m_generation(0), m_busy(0), m_stop(false)
+{
+    if (workers == 0) workers = thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+
+    for (unsigned int i = 1; i < workers; ++i)
+        m_threads.push_back(thread(&ThreadPool::WorkerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (size_t i = 0; i < m_threads.size(); ++i)
+        m_threads[i].join();
+}
+
+ThreadPool &ThreadPool::Shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// --------------------------------------------------------------------------
+
+void ThreadPool::WorkerLoop(unsigned int worker)
+{
+    unsigned long seen = 0;
+    for (;;)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            while (!m_stop && m_generation == seen)
+                m_wake.wait(lock);
+            if (m_stop) return;
+            seen = m_generation;
+        }
+
+        RunTask(worker);
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            if (--m_busy == 0) m_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunTask(unsigned int worker)
+{
+    for (;;)
+    {
+        size_t begin = m_next.fetch_add(m_grain);
+        if (begin >= m_count) break;
+
+        size_t end = begin + m_grain;
+        if (end > m_count) end = m_count;
+        for (size_t i = begin; i < end; ++i)
+            (*m_task)(i, worker);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+void ThreadPool::ParallelFor(size_t count, const Task &task, size_t grain)
+{
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    // not worth waking anyone for a single chunk
+    if (m_threads.empty() || count <= grain)
+    {
+        for (size_t i = 0; i < count; ++i)
+            task(i, 0);
+        return;
+    }
+
+    lock_guard<mutex> submit(m_submit);
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_grain = grain;
+        m_next = 0;
+        m_busy = unsigned(m_threads.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    // the calling thread works as worker 0 until the indices run out
+    RunTask(0);
+
+    unique_lock<mutex> lock(m_mutex);
+    while (m_busy > 0)
+        m_done.wait(lock);
+    m_task = 0;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,72 @@
+// ==========================================================================
+// Worker Thread Pool
+//
+// A fixed set of worker threads for splitting loops over many independent
+// items (glyphs, tiles, image rows) across all cores. The calling thread
+// takes part in the work as worker 0, so a pool of size N starts N-1 threads.
+//  - ParallelFor blocks until every index has been processed
+//  - Each call gets a worker number in [0, Size()) that stays fixed for the
+//    thread, so tasks can keep per-thread resources such as FreeType faces
+// ==========================================================================
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------------
+
+class ThreadPool
+{
+public:
+    // task signature: index of the item to process, and the worker running it
+    typedef std::function<void(size_t index, unsigned int worker)> Task;
+
+private:
+    std::vector<std::thread> m_threads;
+
+    // state of the loop currently being run
+    const Task         *m_task;
+    size_t              m_count;
+    size_t              m_grain;
+    std::atomic<size_t> m_next;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    unsigned long           m_generation;
+    unsigned int            m_busy;
+    bool                    m_stop;
+
+    // serializes loops submitted from different threads
+    std::mutex              m_submit;
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    void WorkerLoop(unsigned int worker);
+    void RunTask(unsigned int worker);
+
+public:
+    // creates a pool with the given number of workers, including the caller;
+    // zero picks one worker per hardware thread
+    explicit ThreadPool(unsigned int workers = 0);
+    ~ThreadPool();
+
+    // a pool shared by everything in the program
+    static ThreadPool &Shared();
+
+    // number of workers, including the calling thread
+    unsigned int Size() const   { return unsigned(m_threads.size()) + 1; }
+
+    // calls task(i, worker) for every i in [0, count), handing out indices
+    // in chunks of grain, and returns once all of them are done
+    void ParallelFor(size_t count, const Task &task, size_t grain = 1);
+};
+
+// --------------------------------------------------------------------------
+#endif // THREADPOOL_H
@@ -0,0 +1,65 @@
+// ==========================================================================
+// Packed Vertex Format
+//
+// See VertexFormat.h for an overview of the packed vertex format.
+// ==========================================================================
+
+#include "VertexFormat.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    short PackCoordinate(float value, float scale)
+    {
+        float packed = floor(value / scale * PACKED_POSITION_MAX + 0.5f);
+        packed = min(max(packed, float(-PACKED_POSITION_MAX)), float(PACKED_POSITION_MAX));
+        return short(packed);
+    }
+
+    unsigned char PackChannel(float value)
+    {
+        return (unsigned char)(min(max(value, 0.f), 1.f) * 255.f + 0.5f);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+float PositionScale(const float *xy, size_t count)
+{
+    float extent = 0.f;
+    for (size_t i = 0; i < 2 * count; ++i)
+        extent = max(extent, fabs(xy[i]));
+
+    float scale = 1.f;
+    while (scale < extent) scale *= 2.f;
+    return scale;
+}
+
+void PackVertices(const float *xy, const float *rgb, size_t count, float scale,
+                  PackedVertex *vertices)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        PackedVertex &vertex = vertices[i];
+        vertex.x = PackCoordinate(xy[2*i], scale);
+        vertex.y = PackCoordinate(xy[2*i + 1], scale);
+        vertex.r = PackChannel(rgb[3*i]);
+        vertex.g = PackChannel(rgb[3*i + 1]);
+        vertex.b = PackChannel(rgb[3*i + 2]);
+        vertex.a = 255;
+    }
+}
+
+void UnpackPosition(const PackedVertex &vertex, float scale, float *xy)
+{
+    // OpenGL maps signed normalized values with max(c / 32767, -1)
+    xy[0] = max(float(vertex.x) / PACKED_POSITION_MAX, -1.f) * scale;
+    xy[1] = max(float(vertex.y) / PACKED_POSITION_MAX, -1.f) * scale;
+}
+
+// --------------------------------------------------------------------------
@@ -0,0 +1,50 @@
+// ==========================================================================
+// Packed Vertex Format
+//
+// Control points are sent to the GPU as one interleaved array of 8-byte
+// vertices, instead of separate arrays of float positions (8 bytes) and
+// float colours (12 bytes):
+//  - positions are 16-bit signed normalized integers, which the vertex
+//    shader reads as -1 to 1 and multiplies by the geometry's position
+//    scale. The scale is the smallest power of two that covers every
+//    coordinate, so the step between positions is scale / 32767: about
+//    1/16000 EM for glyphs, finer than the font units they come from
+//  - colours are 8-bit normalized RGBA, plenty for the few flat colours
+//    curves are drawn in
+// ==========================================================================
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include <cstddef>
+
+// --------------------------------------------------------------------------
+
+// largest magnitude of a packed coordinate
+const int PACKED_POSITION_MAX = 32767;
+
+struct PackedVertex
+{
+    short           x, y;
+    unsigned char   r, g, b, a;
+};
+
+// the position scale for count x,y points: the smallest power of two, and
+// at least 1, that no coordinate exceeds in magnitude
+float PositionScale(const float *xy, size_t count);
+
+// packs count x,y points and r,g,b colours into vertices, with alpha 1
+void PackVertices(const float *xy, const float *rgb, size_t count, float scale,
+                  PackedVertex *vertices);
+
+// whether two vertices are at the same packed position, as the shaders
+// compare them
+inline bool SamePosition(const PackedVertex &a, const PackedVertex &b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+// the position a packed vertex stands for, as the vertex shader sees it
+void UnpackPosition(const PackedVertex &vertex, float scale, float *xy);
+
+// --------------------------------------------------------------------------
+#endif // VERTEXFORMAT_H
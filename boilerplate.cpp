@@ -16,8 +16,17 @@
 #include <string>
 #include <vector>
 #include <iterator>
+#include <map>
+#include <cstring>
+#include <cstddef>
+#include <cmath>
 #include "glm/glm.hpp"
 #include "GlyphExtractor.h"
+#include "TextLayout.h"
+#include "RenderStats.h"
+#include "Bezier.h"
+#include "VertexFormat.h"
+#include "IndexedPatches.h"
 
 // Specify that we want the OpenGL core profile before including GLFW headers
 #ifndef LAB_LINUX
@@ -31,7 +40,7 @@
 //STB
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
-#define STB_IMAGE_WRITE_IMPLEMENTATION
+// the stb_image_write implementation lives in SoftwareRenderer.cpp
 #include <stb_image_write.h>
 using namespace std;
 using namespace glm;
@@ -41,6 +50,15 @@ using namespace glm;
 void QueryGLVersion();
 bool CheckGLErrors();
 
+// CheckGLErrors for per-frame code: glGetError can stall the driver, so
+// release builds (-DNDEBUG) leave it out
+inline void DebugCheckGLErrors()
+{
+#ifndef NDEBUG
+	CheckGLErrors();
+#endif
+}
+
 string LoadSource(const string &filename);
 GLuint CompileShader(GLenum shaderType, const string &source);
 GLuint LinkProgram(GLuint vertexShader, GLuint TCSshader, GLuint TESshader, GLuint fragmentShader);
@@ -54,11 +72,18 @@ struct MyShader
 	GLuint  fragment;
 	GLuint  program;
 
+	// location of the one uniform that is not in the Transform block,
+	// looked up once after linking
+	GLint   positionScale;
+
 	// initialize shader and program names to zero (OpenGL reserved value)
-	MyShader() : vertex(0), fragment(0), program(0)
+	MyShader() : vertex(0), fragment(0), program(0), positionScale(-1)
 	{}
 };
 
+// the binding point of the Transform uniform block
+const GLuint TRANSFORM_BINDING = 0;
+
 // load, compile, and link shaders, returning true if successful
 bool InitializeShaders(MyShader *shader)
 {
@@ -78,6 +103,12 @@ bool InitializeShaders(MyShader *shader)
 	// link shader program
 	shader->program = LinkProgram(shader->vertex, shader->TCS, shader->TES, shader->fragment);
 
+	// look uniforms up once, rather than by name whenever they are set
+	shader->positionScale = glGetUniformLocation(shader->program, "positionScale");
+	GLuint block = glGetUniformBlockIndex(shader->program, "Transform");
+	if (block != GL_INVALID_INDEX)
+		glUniformBlockBinding(shader->program, block, TRANSFORM_BINDING);
+
 	// check for OpenGL errors and return false if error occurred
 	return !CheckGLErrors();
 }
@@ -97,35 +128,106 @@ void DestroyShaders(MyShader *shader)
 // --------------------------------------------------------------------------
 // Functions to set up OpenGL buffers for storing geometry data
 
+// An array buffer that remembers what it was last given, so an update only
+// uploads the bytes that changed. Storage grows geometrically, so buffers that
+// keep growing, like a font's glyphs, are rarely reallocated.
+struct MyBuffer
+{
+	GLuint     name;
+	GLsizeiptr capacity;
+	vector<unsigned char> contents;
+
+	// streaming buffers are rewritten whole whenever they change, into
+	// orphaned storage, so the write never waits on draws still reading the
+	// old contents
+	bool       streaming;
+
+	MyBuffer(bool stream = false) : name(0), capacity(0), streaming(stream)
+	{}
+};
+
 struct MyGeometry
 {
-	// OpenGL names for array buffer objects, vertex array object
-	GLuint  vertexBuffer;
-	GLuint  textureBuffer;
-	GLuint  colourBuffer;
-	GLuint  vertexArray;
-	GLsizei elementCount;
+	// OpenGL names for the array buffer of interleaved PackedVertex control
+	// points (see VertexFormat.h), the element buffer of patch indices into
+	// them (see IndexedPatches.h), and the vertex array object
+	MyBuffer vertexBuffer;
+	MyBuffer indexBuffer;
+	GLuint   vertexArray;
+	GLsizei  elementCount;
+
+	// 16-bit indices while there are few enough points, 32-bit after
+	GLenum   indexType;
+
+	// what the vertex shader multiplies packed positions by
+	float    positionScale;
 
 	// initialize object names to zero (OpenGL reserved value)
-	MyGeometry() : vertexBuffer(0), colourBuffer(0), vertexArray(0), elementCount(0)
+	MyGeometry() : vertexArray(0), elementCount(0), indexType(GL_UNSIGNED_SHORT), positionScale(1)
 	{}
 };
 
+// Text is drawn from a resident buffer that holds each glyph outline of a
+// font once, in the glyph's own EM coordinates. Every character of the phrase
+// is an instance of its glyph, placed by a per-instance offset.
+struct GlyphSlot
+{
+	// first index and number of indices of the glyph's patches in the
+	// resident element buffer
+	GLint   first;
+	GLsizei count;
+
+	// bounding box of the glyph's control points, in EM units
+	vec2    lower;
+	vec2    upper;
+};
+
+struct ResidentFont
+{
+	map<char, GlyphSlot> glyphs;
+	IndexedPatches patches;
+	MyGeometry geometry;
+
+	// colour scheme the outlines were built with, and whether the buffers
+	// are behind the points above
+	bool highlighted;
+	bool dirty;
+
+	ResidentFont() : highlighted(false), dirty(false)
+	{}
+};
+
+// all characters of the phrase that use the same glyph, drawn in one call
+struct GlyphInstances
+{
+	GlyphSlot slot;
+	GLint     firstInstance;
+	GLsizei   instanceCount;
+};
+
+// Control points are marked by instances of one small marker mesh, each
+// placed and coloured by its own instance record.
+struct MyMarker
+{
+	vec2    position;
+	GLubyte colour[4];
+};
+
 // Hold your breath, here come a literal ton of global variables lol
 bool yeah = false;
-MyGeometry lineGeometry;
-MyGeometry quadGeometry;
-MyGeometry cubicGeometry;
+MyGeometry sceneGeometry;
+MyGeometry markerGeometry;
+MyBuffer markerBuffer;
+GLsizei markerCount = 0;
 MyShader shader;
+RenderStats stats;
 bool extras = false;
-vector<vec2> lines;
-vector<vec2> quads;
-vector<vec2> cubics;
-vector<vec3> lineColours;
-vector<vec3> quadColours;
-vector<vec3> cubicColours;
+map<string, ResidentFont> residentFonts;
+ResidentFont *textFont = 0;
+vector<GlyphInstances> textInstances;
+vector<vec2> textOffsets;
+MyBuffer instanceBuffer(true);
 string font = "fonts/AlexBrush-Regular.ttf";
-float charSize = 0;
 int currentFont = 0;
 int currentScale = 0;
 string texts[4] = {"Cameron Hardy", "The quick brown fox jumps over the lazy dog.", "A phrase!", "there is no need to be upset"};
@@ -170,6 +272,104 @@ vec2 info;
 int extraSelect = 0;
 int dSelect = 1;
 
+// set whenever something on screen may have changed; the main loop sleeps
+// until it is set, unless text is scrolling
+bool redraw = true;
+
+// --------------------------------------------------------------------------
+// Render state cache
+//
+// Frame code changes OpenGL state through the functions below, which remember
+// what is bound and skip calls that would change nothing, and count the
+// calls they do make. Nothing is unbound after drawing, so consecutive draws
+// from the same program and geometry bind nothing at all.
+
+// Uniforms shared by every draw, in the std140 layout of the Transform block
+// of vertex.glsl and tessControl.glsl
+struct MyTransform
+{
+	vec2  offset;
+	vec2  scrollOffset;
+	vec2  viewport;
+	float scale;
+	float padding;
+};
+
+struct MyRenderState
+{
+	GLuint program;
+	GLuint vertexArray;
+	GLuint arrayBuffer;
+	GLuint uploadBuffer;
+	float  positionScale;
+
+	MyRenderState() : program(0), vertexArray(0), arrayBuffer(0), uploadBuffer(0), positionScale(-1)
+	{}
+};
+
+MyRenderState renderState;
+MyTransform transformUniforms = { vec2(0, 0), vec2(0, 0), vec2(1024, 1024), 1, 0 };
+MyBuffer transformBuffer;
+
+void useProgram(GLuint program)
+{
+	if (renderState.program == program)
+		return;
+	glUseProgram(program);
+	stats.CountGLCalls();
+	renderState.program = program;
+}
+
+void bindVertexArray(GLuint vertexArray)
+{
+	if (renderState.vertexArray == vertexArray)
+		return;
+	glBindVertexArray(vertexArray);
+	stats.CountGLCalls();
+	renderState.vertexArray = vertexArray;
+}
+
+void bindArrayBuffer(GLuint buffer)
+{
+	if (renderState.arrayBuffer == buffer)
+		return;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	stats.CountGLCalls();
+	renderState.arrayBuffer = buffer;
+}
+
+// buffers are written through their own binding point, so uploads don't
+// disturb the array buffer that attributes are set up from
+void bindUploadBuffer(GLuint buffer)
+{
+	if (renderState.uploadBuffer == buffer)
+		return;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	stats.CountGLCalls();
+	renderState.uploadBuffer = buffer;
+}
+
+// sets the scale of packed positions (see VertexFormat.h) for the next draws
+void setPositionScale(float positionScale)
+{
+	useProgram(shader.program);
+	if (renderState.positionScale == positionScale)
+		return;
+	glUniform1f(shader.positionScale, positionScale);
+	stats.CountGLCalls();
+	renderState.positionScale = positionScale;
+}
+
+void UpdateBuffer(MyBuffer *buffer, const void *data, size_t bytes);
+
+// uploads whatever changed in transformUniforms since the last call
+void updateTransform()
+{
+	UpdateBuffer(&transformBuffer, &transformUniforms, sizeof(transformUniforms));
+}
+
+// --------------------------------------------------------------------------
+
 void RenderGeometry(MyGeometry *geometry)
 {
 	// these vertex attribute indices correspond to those specified for the
@@ -177,63 +377,173 @@ void RenderGeometry(MyGeometry *geometry)
 	const GLuint VERTEX_INDEX = 0;
 	const GLuint COLOUR_INDEX = 1;
 
-	glGenBuffers(1, &geometry->vertexBuffer);
-	glGenBuffers(1, &geometry->colourBuffer);
+	glGenBuffers(1, &geometry->vertexBuffer.name);
+	glGenBuffers(1, &geometry->indexBuffer.name);
 	glGenVertexArrays(1, &geometry->vertexArray);
 
 	// create a vertex array object encapsulating all our vertex attributes
-	glBindVertexArray(geometry->vertexArray);
+	bindVertexArray(geometry->vertexArray);
 
-	// associate the position array with the vertex array object
-	glBindBuffer(GL_ARRAY_BUFFER, geometry->vertexBuffer);
-	glVertexAttribPointer(VERTEX_INDEX, 2, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(VERTEX_INDEX);
+	// the element buffer binding is part of the vertex array object
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry->indexBuffer.name);
 
-	// assocaite the colour array with the vertex array object
-	glBindBuffer(GL_ARRAY_BUFFER, geometry->colourBuffer);
-	glVertexAttribPointer(COLOUR_INDEX, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	// positions and colours are interleaved in one buffer, as normalized
+	// 16-bit coordinates followed by 8-bit RGBA
+	bindArrayBuffer(geometry->vertexBuffer.name);
+	glVertexAttribPointer(VERTEX_INDEX, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+		reinterpret_cast<const void *>(offsetof(PackedVertex, x)));
+	glEnableVertexAttribArray(VERTEX_INDEX);
+	glVertexAttribPointer(COLOUR_INDEX, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex),
+		reinterpret_cast<const void *>(offsetof(PackedVertex, r)));
 	glEnableVertexAttribArray(COLOUR_INDEX);
+}
+
+// sets up a vertex array like RenderGeometry, plus a per-instance offset
+// attribute read from the given instance buffer
+void RenderInstancedGeometry(MyGeometry *geometry, const MyBuffer &instances)
+{
+	const GLuint INSTANCE_INDEX = 2;
+
+	RenderGeometry(geometry);
 
-	// unbind our buffers, resetting to default state
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	bindVertexArray(geometry->vertexArray);
+	bindArrayBuffer(instances.name);
+	glVertexAttribPointer(INSTANCE_INDEX, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribDivisor(INSTANCE_INDEX, 1);
+	glEnableVertexAttribArray(INSTANCE_INDEX);
 }
 
-void InitializeGeometry(MyGeometry *geometry, vector<vec2> points, vector<vec3> colours)
+// sets up a vertex array like RenderGeometry, plus per-instance position and
+// colour attributes read from a buffer of MyMarker records
+void RenderMarkerGeometry(MyGeometry *geometry, const MyBuffer &markers)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, geometry->vertexBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vec2)*points.size(), &points[0], GL_STATIC_DRAW);
+	const GLuint INSTANCE_INDEX = 2;
+	const GLuint INSTANCE_COLOUR_INDEX = 3;
+
+	RenderGeometry(geometry);
+
+	bindVertexArray(geometry->vertexArray);
+	bindArrayBuffer(markers.name);
+	glVertexAttribPointer(INSTANCE_INDEX, 2, GL_FLOAT, GL_FALSE, sizeof(MyMarker),
+		reinterpret_cast<const void *>(offsetof(MyMarker, position)));
+	glVertexAttribDivisor(INSTANCE_INDEX, 1);
+	glEnableVertexAttribArray(INSTANCE_INDEX);
+	glVertexAttribPointer(INSTANCE_COLOUR_INDEX, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MyMarker),
+		reinterpret_cast<const void *>(offsetof(MyMarker, colour)));
+	glVertexAttribDivisor(INSTANCE_COLOUR_INDEX, 1);
+	glEnableVertexAttribArray(INSTANCE_COLOUR_INDEX);
+}
+
+// smallest storage given to a buffer, so the first few glyphs of a font
+// don't each reallocate it
+const GLsizeiptr MIN_BUFFER_CAPACITY = 4096;
+
+// makes a buffer hold the given bytes, uploading only the stretch that
+// differs from what it held before
+void UpdateBuffer(MyBuffer *buffer, const void *data, size_t bytes)
+{
+	const unsigned char *begin = static_cast<const unsigned char *>(data);
+	const unsigned char *end = begin + bytes;
+	const vector<unsigned char> &old = buffer->contents;
+
+	// the changed bytes run from the first difference to the last; bytes
+	// beyond the old contents count as changed
+	size_t first = 0;
+	while (first < bytes && first < old.size() && begin[first] == old[first])
+		first++;
+	size_t last = bytes;
+	if (bytes <= old.size())
+	{
+		while (last > first && begin[last - 1] == old[last - 1])
+			last--;
+	}
+	if (first == last)
+	{
+		buffer->contents.resize(bytes);
+		return;
+	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, geometry->colourBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vec3)*colours.size(), &colours[0], GL_STATIC_DRAW);
+	bindUploadBuffer(buffer->name);
+	if (GLsizeiptr(bytes) > buffer->capacity)
+	{
+		buffer->capacity = std::max(std::max(GLsizeiptr(bytes), 2*buffer->capacity), MIN_BUFFER_CAPACITY);
+		glBufferData(GL_COPY_WRITE_BUFFER, buffer->capacity, 0, buffer->streaming ? GL_STREAM_DRAW : GL_STATIC_DRAW);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, bytes, begin);
+		stats.CountUpload(bytes, true);
+		stats.CountGLCalls(2);
+	}
+	else if (buffer->streaming)
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, buffer->capacity, 0, GL_STREAM_DRAW);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, bytes, begin);
+		stats.CountUpload(bytes, false);
+		stats.CountGLCalls(2);
+	}
+	else
+	{
+		glBufferSubData(GL_COPY_WRITE_BUFFER, first, last - first, begin + first);
+		stats.CountUpload(last - first, false);
+		stats.CountGLCalls();
+	}
 
-	geometry->elementCount = points.size();
+	buffer->contents.assign(begin, end);
+}
+
+// packs control points and their colours into a geometry's vertex buffer,
+// and its patches into the element buffer
+void InitializeGeometry(MyGeometry *geometry, const IndexedPatches &patches)
+{
+	size_t count = patches.PointCount();
+	vector<PackedVertex> vertices;
+	geometry->positionScale = patches.Pack(vertices);
+	UpdateBuffer(&geometry->vertexBuffer, vertices.empty() ? 0 : &vertices[0], sizeof(PackedVertex)*vertices.size());
+
+	const unsigned int *indices = patches.Indices();
+	geometry->elementCount = patches.IndexCount();
+	if (count <= 0x10000)
+	{
+		vector<GLushort> shortIndices(indices, indices + geometry->elementCount);
+		geometry->indexType = GL_UNSIGNED_SHORT;
+		UpdateBuffer(&geometry->indexBuffer, shortIndices.empty() ? 0 : &shortIndices[0], sizeof(GLushort)*shortIndices.size());
+	}
+	else
+	{
+		geometry->indexType = GL_UNSIGNED_INT;
+		UpdateBuffer(&geometry->indexBuffer, indices, sizeof(GLuint)*geometry->elementCount);
+	}
+}
+
+// bytes per index of a geometry's element buffer
+GLsizei indexBytes(const MyGeometry &geometry)
+{
+	return geometry.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
 }
 
 // deallocate geometry-related objects
 void DestroyGeometry(MyGeometry *geometry)
 {
 	// unbind and destroy our vertex array object and associated buffers
-	glBindVertexArray(0);
+	bindVertexArray(0);
+	bindArrayBuffer(0);
+	bindUploadBuffer(0);
 	glDeleteVertexArrays(1, &geometry->vertexArray);
-	glDeleteBuffers(1, &geometry->vertexBuffer);
-	glDeleteBuffers(1, &geometry->colourBuffer);
+	glDeleteBuffers(1, &geometry->vertexBuffer.name);
+	glDeleteBuffers(1, &geometry->indexBuffer.name);
 }
 
 void RenderScene(MyGeometry *geometry, MyShader *shader)
 {
 	// bind our shader program and the vertex array object containing our
 	// scene geometry, then tell OpenGL to draw our geometry
-	glUseProgram(shader->program);
-	glBindVertexArray(geometry->vertexArray);
-	glDrawArrays(GL_PATCHES, 0, geometry->elementCount);
-
-	// reset state to default (no shader or geometry bound)
-	glBindVertexArray(0);
-	glUseProgram(0);
+	useProgram(shader->program);
+	setPositionScale(geometry->positionScale);
+	bindVertexArray(geometry->vertexArray);
+	glDrawElements(GL_PATCHES, geometry->elementCount, geometry->indexType, 0);
+	stats.CountGLCalls();
+	stats.CountDraw(geometry->elementCount / 4);
 
 	// check for an report any OpenGL errors
-	CheckGLErrors();
+	DebugCheckGLErrors();
 }
 
 vector<vec2> drawLines(vector<vec2> points, int degree)
@@ -250,41 +560,60 @@ vector<vec2> drawLines(vector<vec2> points, int degree)
 	return lines;
 }
 
-void addPoints(vector<vec2> *quads, vector<vec2> points, vector<vec3> *colours, vector<vec3> controlColour, int degree)
+// builds the marker mesh: a diamond of four quadratics around the origin,
+// in white so that each instance's colour shows through
+void initializeMarker()
 {
-	uint size = points.size();
-	int c = 0;
-	int spline = 0;
-	for (uint i = 0; i < size; i++)
-	{
-		quads->push_back(vec2(-0.1,  0.0) + points[i]);
-		quads->push_back(vec2(-0.1,  0.1) + points[i]);
-		quads->push_back(vec2( 0.0,  0.1) + points[i]);
+	const vector<vec2> quads = {
+		vec2(-0.1,  0.0), vec2(-0.1,  0.1), vec2( 0.0,  0.1),
+		vec2( 0.0,  0.1), vec2( 0.1,  0.1), vec2( 0.1,  0.0),
+		vec2( 0.1,  0.0), vec2( 0.1, -0.1), vec2( 0.0, -0.1),
+		vec2( 0.0, -0.1), vec2(-0.1, -0.1), vec2(-0.1,  0.0)
+	};
+	const vector<vec3> white(quads.size(), vec3(1.0, 1.0, 1.0));
+
+	IndexedPatches patches;
+	patches.AddSegments(2, &quads[0].x, &white[0].x, quads.size() / 3);
+
+	RenderMarkerGeometry(&markerGeometry, markerBuffer);
+	InitializeGeometry(&markerGeometry, patches);
+}
 
-		quads->push_back(vec2( 0.0,  0.1) + points[i]);
-		quads->push_back(vec2( 0.1,  0.1) + points[i]);
-		quads->push_back(vec2( 0.1,  0.0) + points[i]);
+// marks the control points of segments of the given degree, end points in
+// the first colour and inner points in the second, with one buffer update
+void setMarkers(const vector<vec2> &points, const vector<vec3> &controlColour, int degree)
+{
+	vector<MyMarker> markers(points.size());
+	for (uint i = 0; i < points.size(); i++)
+	{
+		uint k = i % (degree + 1);
+		vec3 colour = controlColour[(k == 0 || k == uint(degree)) ? 0 : 1];
+
+		markers[i].position = points[i];
+		markers[i].colour[0] = GLubyte(colour.r * 255 + 0.5);
+		markers[i].colour[1] = GLubyte(colour.g * 255 + 0.5);
+		markers[i].colour[2] = GLubyte(colour.b * 255 + 0.5);
+		markers[i].colour[3] = 255;
+	}
 
-		quads->push_back(vec2( 0.1,  0.0) + points[i]);
-		quads->push_back(vec2( 0.1, -0.1) + points[i]);
-		quads->push_back(vec2( 0.0, -0.1) + points[i]);
+	UpdateBuffer(&markerBuffer, markers.empty() ? 0 : &markers[0], sizeof(MyMarker)*markers.size());
+	markerCount = markers.size();
+}
 
-		quads->push_back(vec2( 0.0, -0.1) + points[i]);
-		quads->push_back(vec2(-0.1, -0.1) + points[i]);
-		quads->push_back(vec2(-0.1,  0.0) + points[i]);
+// draws an instance of the marker mesh at every marked control point
+void drawMarkers()
+{
+	if (markerCount == 0)
+		return;
 
-		for(int j = 0; j < 12; j++)
-		{
-			colours->push_back(controlColour[c]);
-		}
+	useProgram(shader.program);
+	setPositionScale(markerGeometry.positionScale);
+	bindVertexArray(markerGeometry.vertexArray);
+	glDrawElementsInstanced(GL_PATCHES, markerGeometry.elementCount, markerGeometry.indexType, 0, markerCount);
+	stats.CountGLCalls();
+	stats.CountDraw(markerGeometry.elementCount / 4 * markerCount);
 
-		spline = (spline + 1)%(degree + 1);
-		c = 1;
-		if(spline == 0 || spline == degree)
-		{
-			c = 0;
-		}
-	}
+	DebugCheckGLErrors();
 }
 
 void createColours(vector<vec3> *colours, vec3 colour, int size)
@@ -295,14 +624,39 @@ void createColours(vector<vec3> *colours, vec3 colour, int size)
 	}
 }
 
+// Everything is drawn as cubic patches of 4 control points, so that a whole
+// scene is one draw. This adds the segments in points, degree + 1 control
+// points each, to a set of indexed patches; the tessellation control shader
+// elevates lines and quadratics, which leaves their curves exactly as they
+// were. The tessellation stages only shade with the colours of the two end
+// points.
+void addPatches(IndexedPatches *patches, const vector<vec2> &points, const vector<vec3> &colours, int degree)
+{
+	uint count = points.size() / (degree + 1);
+	if (count == 0)
+		return;
+
+	patches->AddSegments(degree, &points[0].x, &colours[0].x, count);
+}
+
+// uploads a scene's lines, quadratics and cubics as one set of cubic patches
+void setScene(const vector<vec2> &lines, const vector<vec3> &lineColours,
+	const vector<vec2> &quads, const vector<vec3> &quadColours,
+	const vector<vec2> &cubics, const vector<vec3> &cubicColours)
+{
+	IndexedPatches patches;
+	addPatches(&patches, lines, lineColours, 1);
+	addPatches(&patches, quads, quadColours, 2);
+	addPatches(&patches, cubics, cubicColours, 3);
+
+	InitializeGeometry(&sceneGeometry, patches);
+}
+
 void drawKettle() {
-	glUseProgram(shader.program);
-	GLint loc = glGetUniformLocation(shader.program, "offset");
-	glUniform2f(loc, 0,0);
-	loc = glGetUniformLocation(shader.program, "scrollOffset");
-	glUniform2f(loc, 0,0);
-	loc = glGetUniformLocation(shader.program, "scale");
-	glUniform1f(loc, 0.35);
+	transformUniforms.offset = vec2(0, 0);
+	transformUniforms.scrollOffset = vec2(0, 0);
+	transformUniforms.scale = 0.35;
+	updateTransform();
 
 	vector<vec2> quads = {
 		vec2( 1.0,  1.0), vec2( 2.0, -1.0), vec2( 0.0, -1.0),
@@ -322,24 +676,22 @@ void drawKettle() {
 	if(extras) {
 		lines = drawLines(quads, 2);
 		vector<vec3> twoColours = {vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 1.0)};
-		addPoints(&quads, quads, &colours, twoColours, 2);
+		setMarkers(quads, twoColours, 2);
+	}
+	else {
+		setMarkers(vector<vec2>(), vector<vec3>(), 2);
 	}
 
 	createColours(&opaques, vec3(0.6, 0.6, 0.6), lines.size());
 
-	InitializeGeometry(&lineGeometry, lines, opaques);
-	InitializeGeometry(&quadGeometry, quads, colours);
-	InitializeGeometry(&cubicGeometry, cubics, colours);
+	setScene(lines, opaques, quads, colours, cubics, colours);
 }
 
 void drawFish() {
-	glUseProgram(shader.program);
-	GLint loc = glGetUniformLocation(shader.program, "offset");
-	glUniform2f(loc, -0.7, -0.5);
-	loc = glGetUniformLocation(shader.program, "scrollOffset");
-	glUniform2f(loc, 0.0, 0.0);
-	loc = glGetUniformLocation(shader.program, "scale");
-	glUniform1f(loc, 0.18);
+	transformUniforms.offset = vec2(-0.7, -0.5);
+	transformUniforms.scrollOffset = vec2(0.0, 0.0);
+	transformUniforms.scale = 0.18;
+	updateTransform();
 
 	vector<vec2> cubics = {
 		vec2( 1.0,  1.0), vec2( 4.0,  0.0), vec2( 6.0,  2.0), vec2( 9.0,  1.0),
@@ -359,132 +711,215 @@ void drawFish() {
 	if(extras) {
 		lines = drawLines(cubics, 3);
 		vector<vec3> twoColours = {vec3(1.0, 1.0, 0.0), vec3(0.0, 1.0, 1.0)};
-		addPoints(&quads, cubics, &controlColours, twoColours, 3);
+		setMarkers(cubics, twoColours, 3);
+	}
+	else {
+		setMarkers(vector<vec2>(), vector<vec3>(), 3);
 	}
 
 	createColours(&colours, vec3(1.0, 0.4, 0.1), cubics.size());
 	createColours(&opaques, vec3(0.6, 0.6, 0.6), lines.size());
 
-	InitializeGeometry(&lineGeometry, lines, opaques);
-	InitializeGeometry(&quadGeometry, quads, controlColours);
-	InitializeGeometry(&cubicGeometry, cubics, colours);
+	setScene(lines, opaques, quads, controlColours, cubics, colours);
 }
 
-void drawCall()
+// whether a glyph placed at offset can reach into clip space, using the
+// same transform as the vertex shader
+bool instanceVisible(const GlyphSlot &slot, vec2 offset)
 {
-	glUseProgram(shader.program);
-	GLint loc = glGetUniformLocation(shader.program, "mode");
-	glUniform1i(loc, 0);
+	vec2 translation = vec2(tx + xPan, ty);
+	vec2 lower = scale * (slot.lower + offset) + translation;
+	vec2 upper = scale * (slot.upper + offset) + translation;
+	return upper.x >= -1 && lower.x <= 1 && upper.y >= -1 && lower.y <= 1;
+}
 
-	glPatchParameteri(GL_PATCH_VERTICES, 2);
-	RenderScene(&lineGeometry, &shader);
+// draws every glyph of the current phrase from its font's resident buffers
+void drawText()
+{
+	const GLuint INSTANCE_INDEX = 2;
 
-	glUseProgram(shader.program);
-	loc = glGetUniformLocation(shader.program, "mode");
-	glUniform1i(loc, 1);
+	if (!textFont)
+		return;
 
-	glPatchParameteri(GL_PATCH_VERTICES, 3);
-	RenderScene(&quadGeometry, &shader);
+	useProgram(shader.program);
+	setPositionScale(textFont->geometry.positionScale);
+	bindVertexArray(textFont->geometry.vertexArray);
+	bindArrayBuffer(instanceBuffer.name);
+	for(uint i = 0; i < textInstances.size(); i++)
+	{
+		const GlyphInstances &instances = textInstances[i];
+		if (instances.slot.count == 0)
+			continue;
+
+		// a glyph's instances are in reading order, so the ones on screen
+		// are a single stretch of the run; skip the instances either side
+		GLint first = instances.firstInstance;
+		GLint last = first + instances.instanceCount;
+		while (first < last && !instanceVisible(instances.slot, textOffsets[first]))
+			first++;
+		while (last > first && !instanceVisible(instances.slot, textOffsets[last - 1]))
+			last--;
+		if (first == last)
+			continue;
+
+		// point the offset attribute at the visible instances
+		glVertexAttribPointer(INSTANCE_INDEX, 2, GL_FLOAT, GL_FALSE, 0,
+			reinterpret_cast<const void *>(sizeof(vec2)*first));
+		glDrawElementsInstanced(GL_PATCHES, instances.slot.count, textFont->geometry.indexType,
+			reinterpret_cast<const void *>(indexBytes(textFont->geometry)*instances.slot.first), last - first);
+		stats.CountGLCalls(2);
+		stats.CountDraw(instances.slot.count / 4 * (last - first));
+	}
 
-	glUseProgram(shader.program);
-	loc = glGetUniformLocation(shader.program, "mode");
-	glUniform1i(loc, 2);
+	DebugCheckGLErrors();
+}
 
-	glPatchParameteri(GL_PATCH_VERTICES, 4);
-	RenderScene (&cubicGeometry, &shader);
+void drawCall()
+{
+	if (scene == 2) {
+		drawText();
+		return;
+	}
+
+	RenderScene(&sceneGeometry, &shader);
+	drawMarkers();
 }
 
-float setGlyph(char c, vec2 offset)
+// copies a packed array of x,y control points onto the end of points
+void appendPoints(vector<vec2> *points, const float *xy, uint count)
 {
-	GlyphExtractor extractor;
-	MyGlyph glyph;
-	//extractor.LoadFontFile("fonts/GreatVibes-Regular.otf");
-	extractor.LoadFontFile(font);
-	glyph = extractor.ExtractGlyph(c);
+	uint first = points->size();
+	points->resize(first + count);
+	if (count > 0)
+		memcpy(static_cast<void *>(&(*points)[first]), xy, sizeof(vec2)*count);
+}
 
-	MyContour contour;
-	MySegment segment;
+// name of the glyph pack generated for a font file
+string packFile(string fontFile)
+{
+	return "packs/" + fontFile.substr(fontFile.find_last_of('/') + 1) + ".gpk";
+}
 
-	for(uint i = 0; i < glyph.contours.size(); i++)
+// adds a glyph outline to a font's resident buffer, once per character
+void setGlyph(ResidentFont *resident, const GlyphExtractor &extractor, char c)
+{
+	if (resident->glyphs.count(c))
+		return;
+
+	// the packed glyph already has its segments sorted by degree
+	MyPackedGlyph glyph = extractor.ExtractPackedGlyph(c);
+
+	vec3 lineColour;
+	vec3 quadColour;
+	vec3 cubicColour;
+
+	if (yeah) {
+		lineColour = vec3(1.0, 0.0, 0.0);
+		quadColour = vec3(0.0, 1.0, 0.0);
+		cubicColour = vec3(0.0, 0.0, 1.0);
+	}
+	else {
+		lineColour = vec3(0.33, 0.7, 0.33);
+		quadColour = vec3(0.33, 0.7, 0.33);
+		cubicColour = vec3(0.33, 0.7, 0.33);
+	}
+
+	vector<vec2> points[3];
+	vector<vec3> colours[3];
+	for(int d = 0; d < 3; d++)
 	{
-		contour = glyph.contours[i];
-		for(uint j = 0; j < contour.size(); j++)
-		{
-			segment = contour[j];
-			vec3 lineColour;
-			vec3 quadColour;
-			vec3 cubicColour;
-
-			if (yeah) {
-				lineColour = vec3(1.0, 0.0, 0.0);
-				quadColour = vec3(0.0, 1.0, 0.0);
-				cubicColour = vec3(0.0, 0.0, 1.0);
-			}
-			else {
-				lineColour = vec3(0.33, 0.7, 0.33);
-				quadColour = vec3(0.33, 0.7, 0.33);
-				cubicColour = vec3(0.33, 0.7, 0.33);
-			}
-
-			switch (segment.degree)
-			{
-				case (1):
-					lines.push_back(vec2(segment.x[0], segment.y[0])+offset);
-					lines.push_back(vec2(segment.x[1], segment.y[1])+offset);
-
-					lineColours.push_back(lineColour);
-					lineColours.push_back(lineColour);
-					break;
-				case (2):
-					quads.push_back(vec2(segment.x[0], segment.y[0])+offset);
-					quads.push_back(vec2(segment.x[1], segment.y[1])+offset);
-					quads.push_back(vec2(segment.x[2], segment.y[2])+offset);
-
-					quadColours.push_back(quadColour);
-					quadColours.push_back(vec3(1.0, 1.0, 1.0));
-					quadColours.push_back(quadColour);
-					break;
-				case (3):
-					cubics.push_back(vec2(segment.x[0], segment.y[0])+offset);
-					cubics.push_back(vec2(segment.x[1], segment.y[1])+offset);
-					cubics.push_back(vec2(segment.x[2], segment.y[2])+offset);
-					cubics.push_back(vec2(segment.x[3], segment.y[3])+offset);
-
-					cubicColours.push_back(cubicColour);
-					cubicColours.push_back(vec3(1.0, 1.0, 1.0));
-					cubicColours.push_back(vec3(1.0, 1.0, 1.0));
-					cubicColours.push_back(cubicColour);
-					break;
-			}
-		}
+		appendPoints(&points[d], glyph.Points(d + 1), glyph.SegmentCount(d + 1) * (d + 2));
 	}
 
-	charSize = glyph.advance;
-	return glyph.advance;
+	createColours(&colours[0], lineColour, points[0].size());
+	for(uint i = 0; i < points[1].size(); i += 3)
+	{
+		colours[1].push_back(quadColour);
+		colours[1].push_back(vec3(1.0, 1.0, 1.0));
+		colours[1].push_back(quadColour);
+	}
+	for(uint i = 0; i < points[2].size(); i += 4)
+	{
+		colours[2].push_back(cubicColour);
+		colours[2].push_back(vec3(1.0, 1.0, 1.0));
+		colours[2].push_back(vec3(1.0, 1.0, 1.0));
+		colours[2].push_back(cubicColour);
+	}
+
+	GlyphSlot slot;
+	slot.first = resident->patches.IndexCount();
+	for(int d = 0; d < 3; d++)
+	{
+		addPatches(&resident->patches, points[d], colours[d], d + 1);
+	}
+	slot.count = resident->patches.IndexCount() - slot.first;
+
+	slot.lower = slot.upper = vec2(0, 0);
+	GlyphBounds(glyph, &slot.lower.x, &slot.upper.x);
+
+	resident->glyphs[c] = slot;
+	resident->dirty = true;
 }
 
 float setText(string s) {
-	lines.clear();
-	quads.clear();
-	cubics.clear();
-	lineColours.clear();
-	quadColours.clear();
-	cubicColours.clear();
-
-	float textLength = 0;
-	vec2 offset = vec2(0,0);
-	float x;
+	ResidentFont *resident = &residentFonts[font];
+	if (resident->geometry.vertexArray == 0)
+		RenderInstancedGeometry(&resident->geometry, instanceBuffer);
+
+	// outlines carry their colours, so a new colour scheme rebuilds them
+	if (resident->highlighted != yeah)
+	{
+		resident->glyphs.clear();
+		resident->patches.Clear();
+		resident->highlighted = yeah;
+	}
+
+	// use the precompiled glyph pack for this font if one was generated with
+	// "make packs"; otherwise faces come from the font registry, so this
+	// only opens the font file once
+	GlyphExtractor extractor;
+	string pack = packFile(font);
+	if (!ifstream(pack.c_str()) || !extractor.LoadGlyphPack(pack))
+		extractor.LoadFontFile(font);
+
+	// lay the text out from advances and kerning, without loading outlines
+	vector<float> positions;
+	float textLength = LayoutText(extractor, s, positions);
+
+	// only glyphs this font has not drawn before need uploading
 	for(uint i = 0; i < s.size(); i++)
 	{
-		x = setGlyph(s[i], offset);
-		offset += vec2(x,0);
-		textLength += x;
+		setGlyph(resident, extractor, s[i]);
+	}
+	if (resident->dirty)
+	{
+		InitializeGeometry(&resident->geometry, resident->patches);
+		resident->dirty = false;
+	}
+
+	// group the characters by glyph, so each glyph is one instanced draw
+	map<char, vector<vec2> > placements;
+	for(uint i = 0; i < s.size(); i++)
+	{
+		placements[s[i]].push_back(vec2(positions[i], 0));
 	}
 
-	InitializeGeometry(&lineGeometry, lines, lineColours);
-	InitializeGeometry(&quadGeometry, quads, quadColours);
-	InitializeGeometry(&cubicGeometry, cubics, cubicColours);
+	// offsets stay on the CPU too, for culling glyphs that scroll off screen
+	textOffsets.clear();
+	textInstances.clear();
+	for(map<char, vector<vec2> >::iterator it = placements.begin(); it != placements.end(); ++it)
+	{
+		GlyphInstances instances;
+		instances.slot = resident->glyphs[it->first];
+		instances.firstInstance = textOffsets.size();
+		instances.instanceCount = it->second.size();
+		textInstances.push_back(instances);
+		textOffsets.insert(textOffsets.end(), it->second.begin(), it->second.end());
+	}
+
+	UpdateBuffer(&instanceBuffer, textOffsets.empty() ? 0 : &textOffsets[0], sizeof(vec2)*textOffsets.size());
 
+	textFont = resident;
 	return textLength;
 }
 
@@ -503,12 +938,9 @@ void resetUniforms()
 	tx = -(textLen)/2.0;
 	ty = -0.2;
 
-		glUseProgram(shader.program);
-	GLint loc = glGetUniformLocation(shader.program, "offset");
-	glUniform2f(loc, tx, ty);
-
-	loc = glGetUniformLocation(shader.program, "scale");
-	glUniform1f(loc, scale);
+	transformUniforms.offset = vec2(tx, ty);
+	transformUniforms.scale = scale;
+	updateTransform();
 }
 
 void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -516,6 +948,9 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 
+	if (action == GLFW_PRESS)
+		redraw = true;
+
 	// draw that qt kettle
 	if (key == GLFW_KEY_1 && action == GLFW_PRESS) {
 		scene = 0;
@@ -614,11 +1049,40 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 		xPan = 0.0;
 		resetUniforms();
 	}
+
+	// print draw calls and frame times since the last press
+	if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+		stats.Print();
+		stats.Reset();
+	}
 }
 
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
 	scrollSpeed += yoffset / 100;
+
+	// scrolling back as far as forward leaves rounding error rather than
+	// 0, which would keep the main loop from ever sleeping
+	if (fabs(scrollSpeed) < 1e-6)
+		scrollSpeed = 0.0;
+	redraw = true;
+}
+
+// the window system asks for a redraw when the window is uncovered
+void WindowRefreshCallback(GLFWwindow* window)
+{
+	redraw = true;
+}
+
+// the tessellation shader picks how finely to draw each curve from its size
+// in pixels, so it needs to know the size of the window
+void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+	redraw = true;
+
+	transformUniforms.viewport = vec2(width, height);
+	updateTransform();
 }
 
 // ==========================================================================
@@ -649,6 +1113,8 @@ int main(int argc, char *argv[])
 	// set keyboard callback function and make our context current (active)
 	glfwSetKeyCallback(window, KeyCallback);
 	glfwSetScrollCallback(window, ScrollCallback);
+	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+	glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
 	glfwMakeContextCurrent(window);
 
 	//Intialize GLAD if not lab linux
@@ -669,27 +1135,56 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
-	RenderGeometry(&lineGeometry);
-	RenderGeometry(&quadGeometry);
-	RenderGeometry(&cubicGeometry);
+	// the Transform uniform block is read from one buffer by every draw
+	glGenBuffers(1, &transformBuffer.name);
+	updateTransform();
+	glBindBufferBase(GL_UNIFORM_BUFFER, TRANSFORM_BINDING, transformBuffer.name);
+
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	FramebufferSizeCallback(window, width, height);
+
+	RenderGeometry(&sceneGeometry);
+	glGenBuffers(1, &instanceBuffer.name);
+	glGenBuffers(1, &markerBuffer.name);
+
+	// only markers have per-instance colours; everything else reads this
+	// constant value of the attribute instead
+	glVertexAttrib4f(3, 1.0, 1.0, 1.0, 1.0);
 
+	// every curve is drawn as a cubic patch
+	glPatchParameteri(GL_PATCH_VERTICES, 4);
+	glClearColor(0.2, 0.2, 0.2, 1.0);
+
+	initializeMarker();
 	drawKettle();
 
-	// run an event-triggered main loop
-	float r = 1;
+	// run an event-triggered main loop: scrolling text moves every frame,
+	// otherwise the loop sleeps until an event changes what is on screen
 	while (!glfwWindowShouldClose(window))
 	{
-		glClearColor(0.2, 0.2, 0.2, 1.0);
+		if (!redraw && scrollSpeed == 0)
+		{
+			// count the wake-ups that find nothing to draw
+			glfwWaitEvents();
+			if (!redraw)
+				stats.CountSkippedFrame();
+			continue;
+		}
+		redraw = false;
+
+		stats.BeginFrame();
+
 		glClear(GL_COLOR_BUFFER_BIT);
+		stats.CountGLCalls();
+
+		// scroll before drawing, so that culling sees the same offset as
+		// the shaders
+		transformUniforms.scrollOffset = vec2(xPan, 0.0);
+		updateTransform();
 
 		drawCall();
 
-		glUseProgram(shader.program);
-		GLint loc = glGetUniformLocation(shader.program, "scrollOffset");
-		if (loc != -1)
-		{
-		   glUniform2f(loc, xPan, 0.0);
-		}
 		xPan += scrollSpeed;
 		if(xPan> textLen + 1 && scrollSpeed > 0)
 		{
@@ -699,17 +1194,22 @@ int main(int argc, char *argv[])
 		{
 			xPan = textLen + 1;
 		}
-		r = r - 0.05;
-		loc = glGetUniformLocation(shader.program, "p");
-		glUniform1f(loc, r);
-
 		glfwSwapBuffers(window);
+		stats.EndFrame();
 
 		glfwPollEvents();
 	}
 
 	// clean up allocated resources before exit
-	DestroyGeometry(&lineGeometry);
+	DestroyGeometry(&sceneGeometry);
+	DestroyGeometry(&markerGeometry);
+	for(map<string, ResidentFont>::iterator it = residentFonts.begin(); it != residentFonts.end(); ++it)
+	{
+		DestroyGeometry(&it->second.geometry);
+	}
+	glDeleteBuffers(1, &instanceBuffer.name);
+	glDeleteBuffers(1, &markerBuffer.name);
+	glDeleteBuffers(1, &transformBuffer.name);
 	DestroyShaders(&shader);
 	glfwDestroyWindow(window);
 	glfwTerminate();
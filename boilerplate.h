@@ -3,18 +3,25 @@ void DestroyShaders(MyShader);
 
 void InitializeGeometry(MyGeometry);
 void RenderGeometry(MyGeometry);
+void RenderInstancedGeometry(MyGeometry, GLuint);
 void DestroyGeometry(MyGeometry);
 
 void RenderScene(MyGeometry, MyShader);
 void addControlPoints(vector<vec2>, vector<vec2>, vector<vec3>, vector<vec3>, int);
 void removeControlPoints(vector<vec2>, vector<vec3>);
 void createColors(vector<vec3>, vec3, int);
+void elevatePatches(vector<vec2>*, vector<vec3>*, const vector<vec2>&, const vector<vec3>&, int);
+void setScene(const vector<vec2>&, const vector<vec3>&, const vector<vec2>&, const vector<vec3>&, const vector<vec2>&, const vector<vec3>&);
 
 void drawKettle();
 void drawFish();
+bool instanceVisible(const GlyphSlot&, vec2);
+void drawText();
 void drawCall();
 
-float setGlyph(char, vec2);
+void appendPoints(vector<vec2>*, const float*, uint);
+string packFile(string);
+void setGlyph(ResidentFont*, const GlyphExtractor&, char);
 float setText(string);
 
 void ErrorCallback(int, const char*);
@@ -23,6 +30,7 @@ void resetUniforms();
 
 void KeyCallback(GLFWwindow*, int, int, int, int);
 void ScrollCallback(GLFWwindow*, double, double);
+void FramebufferSizeCallback(GLFWwindow*, int, int);
 
 int main(int, char);
 
@@ -18,6 +18,16 @@
 // per vertex out, use "out <type> <name>"
 // per patch out, use  "patch out <type> <name>"
 
+// The subdivision of each patch adapts to its size on screen, using Wang's
+// formula (see Tessellation.h for the CPU version of the same calculation).
+// Patches that are entirely off screen get a level of zero, which tells the
+// tessellator to discard them.
+
+// Lines and quadratics arrive with repeated control points (see
+// IndexedPatches.h): a line from A to B as A, A, B, B and a quadratic as
+// P0, P1, P1, P2. They are elevated to cubics here, before the level is
+// chosen, so the evaluation shader only ever sees cubics.
+
 #version 410
 layout(vertices = 4) out; //How long gl_out[] should be
 
@@ -25,15 +35,74 @@ in vec3 tcColour[];
 
 out vec3 teColour[];
 
+// the same block as in vertex.glsl, for the viewport size
+layout(std140) uniform Transform
+{
+    vec2 offset;
+    vec2 scrollOffset;
+    vec2 viewport;      // in pixels
+    float scale;
+};
+
+uniform float pixelError = 0.25;          // how far the curve may stray, in pixels
+
+const float MIN_LEVEL = 1;
+const float MAX_LEVEL = 64;
+
+// position of a control point in pixels from the centre of the viewport
+vec2 toPixels(vec4 position)
+{
+    return position.xy * 0.5 * viewport;
+}
+
+// the control points of the patch as a cubic
+void elevate(out vec4 c[4])
+{
+    c[0] = gl_in[0].gl_Position;
+    c[1] = gl_in[1].gl_Position;
+    c[2] = gl_in[2].gl_Position;
+    c[3] = gl_in[3].gl_Position;
+
+    if (c[0] == c[1] && c[2] == c[3]) {
+        c[1] = (2*c[0] + c[3]) / 3;
+        c[2] = (c[0] + 2*c[3]) / 3;
+    }
+    else if (c[1] == c[2]) {
+        vec4 middle = c[1];
+        c[1] = (c[0] + 2*middle) / 3;
+        c[2] = (2*middle + c[3]) / 3;
+    }
+}
+
 void main()
 {
+    vec4 c[4];
+    elevate(c);
 
     // gl_InvocationID tells you what input vertex you are working on
     if (gl_InvocationID == 0) {   // only needs to be set once
+        vec2 p0 = toPixels(c[0]);
+        vec2 p1 = toPixels(c[1]);
+        vec2 p2 = toPixels(c[2]);
+        vec2 p3 = toPixels(c[3]);
+
+        // the largest second difference of the control polygon bounds how
+        // far the curve bends away from a straight step
+        float m = max(length(p0 - 2*p1 + p2), length(p1 - 2*p2 + p3));
+
         gl_TessLevelOuter[0] = 1; // only need to draw one line
-        gl_TessLevelOuter[1] = 100; // how much to subdivide each line
+        gl_TessLevelOuter[1] = clamp(ceil(sqrt(0.75 * m / pixelError)), MIN_LEVEL, MAX_LEVEL); // how much to subdivide each line
+
+        // the curve lies within the bounding box of its control points, so a
+        // box that is past any edge of clip space cannot be seen
+        vec2 lower = min(min(c[0].xy, c[1].xy), min(c[2].xy, c[3].xy));
+        vec2 upper = max(max(c[0].xy, c[1].xy), max(c[2].xy, c[3].xy));
+        if (any(greaterThan(lower, vec2(1))) || any(lessThan(upper, vec2(-1)))) {
+            gl_TessLevelOuter[0] = 0;
+            gl_TessLevelOuter[1] = 0;
+        }
     }
 
-    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;	// pass control points to TES
+    gl_out[gl_InvocationID].gl_Position = c[gl_InvocationID];	// pass control points to TES
     teColour[gl_InvocationID] = tcColour[gl_InvocationID]; 						// pass colours to TES
 }
@@ -0,0 +1,88 @@
+// ==========================================================================
+// Glyph Atlas Builder
+//
+// Builds a multi-channel distance field atlas of the printable ASCII glyphs
+// of a font (see GlyphAtlas.h), writing the image to <prefix>.png and the
+// glyph metrics to <prefix>.atlas.
+//
+// Usage: atlasbuild <font file> <output prefix> [options]
+//  --size n        pixels per EM of the fields (default 32)
+//  --range r       distance in pixels covered by the values 0 to 255
+//                  (default 4)
+//  --width w       width of the image in pixels (default: a power of two
+//                  that keeps the image about square)
+// ==========================================================================
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GlyphAtlas.h"
+#include "GlyphExtractor.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    const int FIRST_CHARACTER = 32;
+    const int LAST_CHARACTER = 126;
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " <font file> <output prefix> [--size n] [--range r]"
+             << " [--width w]" << endl;
+        return 1;
+    }
+
+    string fontFile = argv[1];
+    string prefix = argv[2];
+    float size = 32.f, range = DEFAULT_DISTANCE_RANGE;
+    int width = 0;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) size = float(atof(argv[++i]));
+        else if (arg == "--range" && i + 1 < argc) range = float(atof(argv[++i]));
+        else if (arg == "--width" && i + 1 < argc) width = atoi(argv[++i]);
+        else {
+            cout << "atlasbuild ERROR: unknown option " << arg << endl;
+            return 1;
+        }
+    }
+    if (size <= 0.f || range <= 0.f) {
+        cout << "atlasbuild ERROR: size and range must be positive" << endl;
+        return 1;
+    }
+
+    GlyphExtractor extractor;
+    if (!extractor.LoadFontFile(fontFile))
+        return 1;
+
+    vector<int> characters;
+    for (int c = FIRST_CHARACTER; c <= LAST_CHARACTER; ++c)
+        characters.push_back(c);
+
+    Clock::time_point start = Clock::now();
+    GlyphAtlas atlas;
+    if (!atlas.Build(extractor, characters, size, range, width))
+        return 1;
+    double milliseconds = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    if (!atlas.WritePNG(prefix + ".png") || !atlas.WriteMetrics(prefix + ".atlas"))
+        return 1;
+
+    cout << prefix << ": " << atlas.Glyphs().size() << " glyphs in " << atlas.Width()
+         << "x" << atlas.Height() << " pixels, built in " << milliseconds << " ms" << endl;
+    return 0;
+}
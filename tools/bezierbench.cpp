@@ -0,0 +1,179 @@
+// ==========================================================================
+// Batched Bezier Evaluation Benchmark
+//
+// Compares the SIMD and scalar paths of BezierBatch on the quadratic and
+// cubic segments of every glyph in the fonts given, evaluated on grids of a
+// few sizes, and checks that both paths produce the same points. It also
+// checks that Bezier<D>::EvaluateGrid, which walks a segment by forward
+// differencing, lands within GRID_TOLERANCE of Bezier<D>::Evaluate at
+// every grid point, up to the shader's largest tessellation level. Segments
+// are evaluated a chunk at a time into a buffer that stays in cache, as a
+// caller that consumes the points straight away would; evaluating all of
+// them into one large buffer measures memory bandwidth instead.
+//
+// Usage: bezierbench <font file> ...
+// ==========================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "Bezier.h"
+#include "BezierBatch.h"
+#include "GlyphExtractor.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+    typedef void (*Evaluator)(const float *, unsigned int, size_t, unsigned int, float *);
+
+    const unsigned int STEPS[] = { 8, 32, 64 };
+
+    // keep timing each case until this much time has passed
+    const double MIN_SECONDS = 0.5;
+
+    // segments evaluated per call
+    const size_t CHUNK = 256;
+
+    // grid sizes for the forward differencing check, the last the largest
+    // tessellation level of the shaders
+    const unsigned int GRID_STEPS[] = { 1, 4, 8, 32, 64 };
+
+    // furthest, in EM units, a forward differenced point may be from the
+    // same point evaluated directly
+    const float GRID_TOLERANCE = 1e-6f;
+
+    // largest distance in x or y between the grid walk and direct
+    // evaluation of each segment
+    template <unsigned int Degree>
+    float GridError(const vector<float> &xy, unsigned int steps)
+    {
+        size_t count = xy.size() / (2 * (Degree + 1));
+        vector<float> grid(2 * (steps + 1));
+
+        float error = 0.f;
+        for (size_t s = 0; s < count; ++s)
+        {
+            const float *segment = &xy[s * 2 * (Degree + 1)];
+            Bezier<Degree>::EvaluateGrid(segment, steps, &grid[0]);
+            for (unsigned int j = 0; j <= steps; ++j)
+            {
+                float point[2];
+                Bezier<Degree>::Evaluate(segment, float(j) / steps, point);
+                error = max(error, max(fabs(grid[2*j] - point[0]), fabs(grid[2*j + 1] - point[1])));
+            }
+        }
+        return error;
+    }
+
+    // returns segments evaluated per second
+    double Time(Evaluator evaluate, const vector<float> &xy, unsigned int degree,
+                unsigned int steps)
+    {
+        size_t count = xy.size() / (2 * (degree + 1));
+        vector<float> points(CHUNK * 2 * (steps + 1));
+
+        size_t passes = 0;
+        double seconds = 0.0;
+        Clock::time_point start = Clock::now();
+        do {
+            for (size_t first = 0; first < count; first += CHUNK)
+                evaluate(&xy[first * 2 * (degree + 1)], degree, min(CHUNK, count - first),
+                         steps, &points[0]);
+            ++passes;
+            seconds = chrono::duration<double>(Clock::now() - start).count();
+        } while (seconds < MIN_SECONDS);
+
+        return count * passes / seconds;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <font file> ..." << endl;
+        return 1;
+    }
+
+    // control points of every quadratic and cubic, straight from the
+    // packed glyphs' degree buckets
+    vector<float> curves[2];
+    for (int f = 1; f < argc; ++f)
+    {
+        GlyphExtractor extractor;
+        if (!extractor.LoadFontFile(argv[f]))
+            return 1;
+
+        vector<int> characters = extractor.CharacterCodes();
+        if (characters.empty()) continue;
+
+        vector<MyPackedGlyph> glyphs = extractor.ExtractPackedGlyphs(&characters[0], characters.size());
+        for (size_t g = 0; g < glyphs.size(); ++g)
+        {
+            for (unsigned int degree = 2; degree <= 3; ++degree)
+            {
+                const float *points = glyphs[g].Points(degree);
+                size_t floats = glyphs[g].SegmentCount(degree) * 2 * (degree + 1);
+                curves[degree - 2].insert(curves[degree - 2].end(), points, points + floats);
+            }
+        }
+    }
+
+    cout << "SIMD path: " << BezierBatchPath() << endl;
+
+    bool match = true;
+    for (unsigned int degree = 2; degree <= 3; ++degree)
+    {
+        const vector<float> &xy = curves[degree - 2];
+        size_t count = xy.size() / (2 * (degree + 1));
+        if (count == 0) continue;
+
+        for (size_t s = 0; s < sizeof(STEPS) / sizeof(STEPS[0]); ++s)
+        {
+            double simdRate = Time(EvaluateBezierBatch, xy, degree, STEPS[s]);
+            double scalarRate = Time(EvaluateBezierBatchScalar, xy, degree, STEPS[s]);
+
+            vector<float> simd(count * 2 * (STEPS[s] + 1)), scalar(simd.size());
+            EvaluateBezierBatch(&xy[0], degree, count, STEPS[s], &simd[0]);
+            EvaluateBezierBatchScalar(&xy[0], degree, count, STEPS[s], &scalar[0]);
+
+            float difference = 0.f;
+            for (size_t i = 0; i < simd.size(); ++i)
+                difference = max(difference, fabs(simd[i] - scalar[i]));
+            match = match && difference <= 1e-6f;
+
+            cout << (degree == 2 ? "quadratics" : "cubics") << " x " << count
+                 << ", " << STEPS[s] << " steps: scalar " << scalarRate / 1e6
+                 << " M segments/s, " << BezierBatchPath() << " " << simdRate / 1e6
+                 << " M segments/s, speedup " << simdRate / scalarRate
+                 << ", largest difference " << difference << endl;
+        }
+    }
+
+    for (unsigned int degree = 2; degree <= 3; ++degree)
+    {
+        const vector<float> &xy = curves[degree - 2];
+        if (xy.empty()) continue;
+
+        for (size_t s = 0; s < sizeof(GRID_STEPS) / sizeof(GRID_STEPS[0]); ++s)
+        {
+            float error = degree == 2 ? GridError<2>(xy, GRID_STEPS[s])
+                                      : GridError<3>(xy, GRID_STEPS[s]);
+            match = match && error <= GRID_TOLERANCE;
+
+            cout << (degree == 2 ? "quadratics" : "cubics") << ", " << GRID_STEPS[s]
+                 << " step grid: largest difference from direct evaluation " << error
+                 << (error <= GRID_TOLERANCE ? "" : " FAILED") << endl;
+        }
+    }
+
+    return match ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+// ==========================================================================
+// Fill Rasterizer Benchmark
+//
+// Compares FillRasterizer with FreeType's own anti-aliased rasterizer on
+// the printable ASCII glyphs of every font given:
+//  - agreement: mean and largest coverage difference from FreeType's
+//    unhinted bitmaps, with both placed at the same origin
+//  - single glyphs: glyphs per second at a few pixel sizes, one thread,
+//    into bitmaps the size of FreeType's, from outlines already loaded
+//  - a page: a 1024x1024 page of text at 32 pixels per EM, FreeType one
+//    glyph at a time, FillRasterizer as one tiled pass on the shared pool
+//
+// Usage: fillbench <font file> ...
+// ==========================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+#include "FillRasterizer.h"
+#include "GlyphExtractor.h"
+#include "TextLayout.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    const int SIZES[] = { 16, 64, 256 };
+    const int PAGE = 1024;
+    const int PAGE_SIZE = 32;
+    const char *PAGE_TEXT = "The quick brown fox jumps over the lazy dog.";
+
+    // keep timing each case until this much time has passed
+    const double MIN_SECONDS = 0.3;
+
+    double Seconds(Clock::time_point start)
+    {
+        return chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // a glyph outline scaled by FreeType to a pixel size, and the bitmap it
+    // fills, placed so that the outline's origin is at (left, top) in pixels
+    struct ScaledGlyph
+    {
+        int             character;
+        FT_Outline      outline;
+        int             left, top, width, height;
+    };
+
+    bool LoadScaled(FT_Library library, FT_Face face, int character, ScaledGlyph &glyph)
+    {
+        if (FT_Load_Char(face, character, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP) != 0)
+            return false;
+
+        FT_Outline &source = face->glyph->outline;
+        if (source.n_points == 0) return false;
+
+        FT_BBox box;
+        FT_Outline_Get_CBox(&source, &box);
+        int xMin = int(floor(box.xMin / 64.0)), yMin = int(floor(box.yMin / 64.0));
+        int xMax = int(ceil(box.xMax / 64.0)), yMax = int(ceil(box.yMax / 64.0));
+
+        glyph.character = character;
+        glyph.left = xMin;
+        glyph.top = yMax;
+        glyph.width = xMax - xMin;
+        glyph.height = yMax - yMin;
+        if (glyph.width <= 0 || glyph.height <= 0) return false;
+
+        FT_Outline_New(library, source.n_points, source.n_contours, &glyph.outline);
+        FT_Outline_Copy(&source, &glyph.outline);
+        FT_Outline_Translate(&glyph.outline, -xMin * 64, -yMin * 64);
+        return true;
+    }
+
+    void RenderFreeType(FT_Library library, ScaledGlyph &glyph, vector<unsigned char> &pixels)
+    {
+        pixels.assign(size_t(glyph.width) * glyph.height, 0);
+
+        FT_Bitmap bitmap;
+        bitmap.rows = glyph.height;
+        bitmap.width = glyph.width;
+        bitmap.pitch = glyph.width;
+        bitmap.buffer = &pixels[0];
+        bitmap.num_grays = 256;
+        bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+        bitmap.palette_mode = 0;
+        bitmap.palette = 0;
+        FT_Outline_Get_Bitmap(library, &glyph.outline, &bitmap);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <font file> ..." << endl;
+        return 1;
+    }
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library) != 0) {
+        cout << "FreeType ERROR: could not initialize" << endl;
+        return 1;
+    }
+
+    ThreadPool serial(1);
+    double difference = 0.0, pixels = 0.0;
+    int worst = 0;
+    double freetypeGlyphs[3] = { 0, 0, 0 }, freetypeSeconds[3] = { 0, 0, 0 };
+    double fillGlyphs[3] = { 0, 0, 0 }, fillSeconds[3] = { 0, 0, 0 };
+    double freetypePage = 0.0, fillPage = 0.0;
+
+    for (int f = 1; f < argc; ++f)
+    {
+        GlyphExtractor extractor;
+        FT_Face face;
+        if (!extractor.LoadFontFile(argv[f]) || FT_New_Face(library, argv[f], 0, &face) != 0) {
+            cout << "ERROR: could not load " << argv[f] << endl;
+            return 1;
+        }
+
+        vector<MyGlyph> outlines(128);
+        for (int c = 33; c < 127; ++c)
+            outlines[c] = extractor.ExtractGlyph(c);
+
+        for (int s = 0; s < 3; ++s)
+        {
+            int size = SIZES[s];
+            FT_Set_Pixel_Sizes(face, 0, size);
+
+            vector<ScaledGlyph> glyphs;
+            for (int c = 33; c < 127; ++c)
+            {
+                ScaledGlyph glyph;
+                if (LoadScaled(library, face, c, glyph)) glyphs.push_back(glyph);
+            }
+
+            // one rasterizer per glyph, sized like FreeType's bitmap
+            vector<FillRasterizer *> rasterizers;
+            for (size_t g = 0; g < glyphs.size(); ++g)
+                rasterizers.push_back(new FillRasterizer(glyphs[g].width, glyphs[g].height, 0.2f, serial));
+
+            vector<unsigned char> reference, coverage;
+
+            // agreement, at the middle size only
+            if (size == 64)
+            {
+                for (size_t g = 0; g < glyphs.size(); ++g)
+                {
+                    ScaledGlyph &glyph = glyphs[g];
+                    RenderFreeType(library, glyph, reference);
+
+                    FillRasterizer &fill = *rasterizers[g];
+                    coverage.assign(reference.size(), 0);
+                    fill.Clear();
+                    fill.AddGlyph(outlines[glyph.character], float(size), float(-glyph.left), float(glyph.top));
+                    fill.Render(&coverage[0], glyph.width);
+
+                    for (size_t i = 0; i < coverage.size(); ++i)
+                    {
+                        int d = abs(int(coverage[i]) - int(reference[i]));
+                        difference += d;
+                        worst = max(worst, d);
+                    }
+                    pixels += coverage.size();
+                }
+            }
+
+            // FreeType, one glyph at a time
+            size_t count = 0;
+            Clock::time_point start = Clock::now();
+            do {
+                for (size_t g = 0; g < glyphs.size(); ++g, ++count)
+                    RenderFreeType(library, glyphs[g], reference);
+            } while (Seconds(start) < MIN_SECONDS);
+            freetypeSeconds[s] += Seconds(start);
+            freetypeGlyphs[s] += count;
+
+            count = 0;
+            start = Clock::now();
+            do {
+                for (size_t g = 0; g < glyphs.size(); ++g, ++count)
+                {
+                    ScaledGlyph &glyph = glyphs[g];
+                    FillRasterizer &fill = *rasterizers[g];
+                    coverage.resize(size_t(glyph.width) * glyph.height);
+                    fill.Clear();
+                    fill.AddGlyph(outlines[glyph.character], float(size), float(-glyph.left), float(glyph.top));
+                    fill.Render(&coverage[0], glyph.width);
+                }
+            } while (Seconds(start) < MIN_SECONDS);
+            fillSeconds[s] += Seconds(start);
+            fillGlyphs[s] += count;
+
+            for (size_t g = 0; g < glyphs.size(); ++g) {
+                FT_Outline_Done(library, &glyphs[g].outline);
+                delete rasterizers[g];
+            }
+        }
+
+        // a page of text lines at PAGE_SIZE pixels per EM
+        FT_Set_Pixel_Sizes(face, 0, PAGE_SIZE);
+        string text = PAGE_TEXT;
+        vector<float> positions;
+        LayoutText(extractor, text, positions);
+
+        vector<ScaledGlyph> glyphs(128);
+        vector<bool> loaded(128, false);
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            int c = (unsigned char)text[i];
+            if (!loaded[c] && c < 128) loaded[c] = LoadScaled(library, face, c, glyphs[c]);
+        }
+
+        vector<unsigned char> page(size_t(PAGE) * PAGE), bitmap;
+        int lines = PAGE / PAGE_SIZE - 1;
+
+        Clock::time_point start = Clock::now();
+        int passes = 0;
+        do {
+            fill(page.begin(), page.end(), 0);
+            for (int line = 0; line < lines; ++line)
+            {
+                int baseline = (line + 1) * PAGE_SIZE;
+                for (size_t i = 0; i < text.size(); ++i)
+                {
+                    int c = (unsigned char)text[i];
+                    if (!loaded[c]) continue;
+                    ScaledGlyph &glyph = glyphs[c];
+                    RenderFreeType(library, glyph, bitmap);
+
+                    // blit with max, clipping to the page
+                    int x0 = int(floor(positions[i] * PAGE_SIZE)) + glyph.left;
+                    int y0 = baseline - glyph.top;
+                    for (int y = 0; y < glyph.height; ++y)
+                    {
+                        if (y0 + y < 0 || y0 + y >= PAGE) continue;
+                        for (int x = 0; x < glyph.width; ++x)
+                        {
+                            if (x0 + x < 0 || x0 + x >= PAGE) continue;
+                            unsigned char &out = page[size_t(y0 + y) * PAGE + x0 + x];
+                            out = max(out, bitmap[size_t(y) * glyph.width + x]);
+                        }
+                    }
+                }
+            }
+            ++passes;
+        } while (Seconds(start) < MIN_SECONDS);
+        freetypePage += Seconds(start) / passes;
+
+        FillRasterizer fillPageRasterizer(PAGE, PAGE);
+        start = Clock::now();
+        passes = 0;
+        do {
+            fillPageRasterizer.Clear();
+            for (int line = 0; line < lines; ++line)
+                for (size_t i = 0; i < text.size(); ++i)
+                    fillPageRasterizer.AddGlyph(outlines[(unsigned char)text[i] & 127], float(PAGE_SIZE),
+                                                positions[i] * PAGE_SIZE, float((line + 1) * PAGE_SIZE));
+            fillPageRasterizer.Render(&page[0], PAGE);
+            ++passes;
+        } while (Seconds(start) < MIN_SECONDS);
+        fillPage += Seconds(start) / passes;
+
+        for (int c = 0; c < 128; ++c)
+            if (loaded[c]) FT_Outline_Done(library, &glyphs[c].outline);
+        FT_Done_Face(face);
+    }
+
+    cout << "coverage difference from FreeType at 64 px: mean " << difference / pixels
+         << ", largest " << worst << " (of 255)" << endl;
+    for (int s = 0; s < 3; ++s)
+    {
+        double freetypeRate = freetypeGlyphs[s] / freetypeSeconds[s];
+        double fillRate = fillGlyphs[s] / fillSeconds[s];
+        cout << SIZES[s] << " px glyphs: FreeType " << freetypeRate / 1e3 << " k/s, FillRasterizer "
+             << fillRate / 1e3 << " k/s, ratio " << fillRate / freetypeRate << endl;
+    }
+    cout << "1024x1024 page at " << PAGE_SIZE << " px: FreeType " << 1e3 * freetypePage / (argc - 1)
+         << " ms, FillRasterizer " << 1e3 * fillPage / (argc - 1) << " ms on "
+         << ThreadPool::Shared().Size() << " threads" << endl;
+
+    FT_Done_FreeType(library);
+    return 0;
+}
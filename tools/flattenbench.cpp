@@ -0,0 +1,155 @@
+// ==========================================================================
+// Bezier Flattening Benchmark
+//
+// Measures how fast BezierFlatten turns glyph outlines into polylines. Every
+// glyph in the character map of each font given is decoded, then all of
+// their segments are flattened repeatedly at a range of tolerances. For the
+// default tolerance, the polylines are also checked against points sampled
+// along the true curves, to confirm the error bound holds.
+//
+// Usage: flattenbench <font file> ...
+// ==========================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BezierFlatten.h"
+#include "GlyphExtractor.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    // tolerances to benchmark, in EM units; 1/1024 EM is about a tenth of a
+    // pixel for text drawn 128 pixels high
+    const float TOLERANCES[] = { 1.f / 64, 1.f / 256, 1.f / 1024, 1.f / 4096 };
+    const float CHECK_TOLERANCE = 1.f / 1024;
+
+    // keep timing each tolerance until this much time has passed
+    const double MIN_SECONDS = 0.5;
+
+    void Evaluate(const MySegment &segment, float t, float *point)
+    {
+        // de Casteljau, which works for every degree
+        float x[4], y[4];
+        for (unsigned int i = 0; i <= segment.degree; ++i) {
+            x[i] = segment.x[i];
+            y[i] = segment.y[i];
+        }
+        for (unsigned int level = 1; level <= segment.degree; ++level)
+        {
+            for (unsigned int i = 0; i + level <= segment.degree; ++i) {
+                x[i] += t * (x[i + 1] - x[i]);
+                y[i] += t * (y[i + 1] - y[i]);
+            }
+        }
+        point[0] = x[0];
+        point[1] = y[0];
+    }
+
+    // distance from a point to the nearest step of a polyline
+    float PolylineDistance(const float *p, const float *polyline, size_t count)
+    {
+        float best = INFINITY;
+        for (size_t i = 0; i + 1 < count; ++i)
+        {
+            const float *a = polyline + 2*i;
+            const float *b = a + 2;
+            float dx = b[0] - a[0], dy = b[1] - a[1];
+            float px = p[0] - a[0], py = p[1] - a[1];
+            float length2 = dx*dx + dy*dy;
+            float t = length2 > 0.f ? (px*dx + py*dy) / length2 : 0.f;
+            t = min(max(t, 0.f), 1.f);
+            best = min(best, hypot(px - t*dx, py - t*dy));
+        }
+        return best;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <font file> ..." << endl;
+        return 1;
+    }
+
+    // gather the segments of every glyph of every font
+    vector<MySegment> segments;
+    size_t glyphCount = 0;
+    for (int f = 1; f < argc; ++f)
+    {
+        GlyphExtractor extractor;
+        if (!extractor.LoadFontFile(argv[f]))
+            return 1;
+
+        vector<int> characters = extractor.CharacterCodes();
+        if (characters.empty()) continue;
+
+        vector<MyGlyph> glyphs = extractor.ExtractGlyphs(&characters[0], characters.size());
+        for (size_t g = 0; g < glyphs.size(); ++g)
+            for (size_t c = 0; c < glyphs[g].contours.size(); ++c)
+                segments.insert(segments.end(), glyphs[g].contours[c].begin(),
+                                glyphs[g].contours[c].end());
+        glyphCount += glyphs.size();
+    }
+    cout << glyphCount << " glyphs, " << segments.size() << " segments" << endl;
+
+    // one buffer serves every segment
+    vector<float> polyline(2 * FLATTEN_MAX_POINTS);
+
+    for (size_t t = 0; t < sizeof(TOLERANCES) / sizeof(TOLERANCES[0]); ++t)
+    {
+        float tolerance = TOLERANCES[t];
+        size_t passes = 0, points = 0;
+
+        Clock::time_point start = Clock::now();
+        double seconds = 0.0;
+        do {
+            points = 0;
+            for (size_t s = 0; s < segments.size(); ++s)
+                points += FlattenSegment(segments[s], tolerance, &polyline[0], FLATTEN_MAX_POINTS);
+            ++passes;
+            seconds = chrono::duration<double>(Clock::now() - start).count();
+        } while (seconds < MIN_SECONDS);
+
+        double perPass = seconds / passes;
+        cout << "tolerance 1/" << int(1.f / tolerance) << " EM: "
+             << segments.size() / perPass / 1e6 << " M segments/s, "
+             << points / perPass / 1e6 << " M points/s, "
+             << double(points) / segments.size() << " points per segment" << endl;
+    }
+
+    // check the bound: points along each curve must be near its polyline
+    float worst = 0.f;
+    const int SAMPLES = 32;
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+        const MySegment &segment = segments[s];
+        if (segment.degree == 0) continue;
+
+        polyline[0] = segment.x[0];
+        polyline[1] = segment.y[0];
+        size_t count = 1 + FlattenSegment(segment, CHECK_TOLERANCE, &polyline[2], FLATTEN_MAX_POINTS - 1);
+
+        for (int i = 1; i < SAMPLES; ++i)
+        {
+            float point[2];
+            Evaluate(segment, float(i) / SAMPLES, point);
+            worst = max(worst, PolylineDistance(point, &polyline[0], count));
+        }
+    }
+    cout << "largest sampled error at tolerance 1/" << int(1.f / CHECK_TOLERANCE)
+         << " EM: " << worst * int(1.f / CHECK_TOLERANCE) << " of the tolerance" << endl;
+
+    return worst <= CHECK_TOLERANCE ? 0 : 1;
+}
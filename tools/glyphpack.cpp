@@ -0,0 +1,47 @@
+// ==========================================================================
+// Glyph Pack Converter
+//
+// Converts a font file into a glyph pack (see GlyphPack.h) holding every
+// glyph in the font's character map, already in EM units, and the font's
+// kerning pairs.
+//
+// Usage: glyphpack <font file> <pack file>
+// ==========================================================================
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GlyphExtractor.h"
+#include "GlyphPack.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        cout << "Usage: " << argv[0] << " <font file> <pack file>" << endl;
+        return 1;
+    }
+
+    GlyphExtractor extractor;
+    if (!extractor.LoadFontFile(argv[1]))
+        return 1;
+
+    // decode the whole character map in one parallel batch
+    vector<int> characters = extractor.CharacterCodes();
+    vector<MyPackedGlyph> glyphs;
+    if (!characters.empty())
+        glyphs = extractor.ExtractPackedGlyphs(&characters[0], characters.size());
+
+    if (!WriteGlyphPack(argv[2], characters, glyphs, extractor.Kerning().Pairs()))
+        return 1;
+
+    // read the pack back to make sure it loads
+    GlyphExtractor check;
+    if (!check.LoadGlyphPack(argv[2]))
+        return 1;
+
+    cout << argv[1] << ": " << glyphs.size() << " glyphs written to " << argv[2] << endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+// ==========================================================================
+// Headless Text Renderer
+//
+// Renders a phrase the way the main program draws it, with the software
+// renderer instead of OpenGL, and writes the frame to a PNG. Useful for
+// regression images and batch jobs on machines without a GPU.
+//
+// Usage: headless <font file> <png file> [options] [text]
+//  --scale s       text scale, as in the main program (default 0.25)
+//  --scroll x      horizontal scrollOffset (default 0)
+//  --size n        width and height of the image in pixels (default 1024)
+//  --highlight     colour lines, quadratics and cubics as the space bar does
+// ==========================================================================
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Bezier.h"
+#include "GlyphExtractor.h"
+#include "SoftwareRenderer.h"
+#include "TextLayout.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    // renders are repeated to time them
+    const int TIMED_RENDERS = 20;
+
+    // a glyph outline as cubic patches, with a colour per control point
+    struct GlyphPatches
+    {
+        vector<float>   xy;
+        vector<float>   rgb;
+    };
+
+    // a glyph as cubic patches, each coloured by the degree it started as
+    void BuildPatches(const MyPackedGlyph &glyph, const float *colours, GlyphPatches &patches)
+    {
+        AppendCubics(glyph, patches.xy);
+        for (unsigned int d = 1; d <= 3; ++d)
+        {
+            for (size_t i = 0; i < 4 * glyph.SegmentCount(d); ++i)
+                patches.rgb.insert(patches.rgb.end(), colours + 3*(d - 1), colours + 3*d);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " <font file> <png file> [--scale s] [--scroll x]"
+             << " [--size n] [--highlight] [text]" << endl;
+        return 1;
+    }
+
+    string fontFile = argv[1];
+    string pngFile = argv[2];
+    string text = "The quick brown fox jumps over the lazy dog.";
+    float scale = 0.25f, scroll = 0.f;
+    int size = 1024;
+    bool highlight = false;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc) scale = float(atof(argv[++i]));
+        else if (arg == "--scroll" && i + 1 < argc) scroll = float(atof(argv[++i]));
+        else if (arg == "--size" && i + 1 < argc) size = atoi(argv[++i]);
+        else if (arg == "--highlight") highlight = true;
+        else text = arg;
+    }
+
+    GlyphExtractor extractor;
+    if (!extractor.LoadFontFile(fontFile))
+        return 1;
+
+    // same colours as setGlyph in the main program
+    const float plain[9] = { 0.33f, 0.7f, 0.33f, 0.33f, 0.7f, 0.33f, 0.33f, 0.7f, 0.33f };
+    const float degrees[9] = { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
+
+    // each glyph once, and the places it appears in the text
+    vector<float> positions;
+    float length = LayoutText(extractor, text, positions);
+
+    map<char, GlyphPatches> glyphs;
+    map<char, vector<float> > placements;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        char c = text[i];
+        if (!glyphs.count(c))
+            BuildPatches(extractor.ExtractPackedGlyph(c), highlight ? degrees : plain, glyphs[c]);
+        placements[c].push_back(positions[i]);
+        placements[c].push_back(0.f);
+    }
+
+    // centred as resetUniforms does it
+    RenderUniforms uniforms;
+    uniforms.scale = scale;
+    uniforms.offset[0] = -length * scale / 2.f;
+    uniforms.offset[1] = -0.2f;
+    uniforms.scrollOffset[0] = scroll;
+
+    SoftwareRenderer renderer(size, size);
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < TIMED_RENDERS; ++r)
+    {
+        renderer.Clear(0.2f, 0.2f, 0.2f);
+        for (map<char, GlyphPatches>::iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+        {
+            const GlyphPatches &patches = it->second;
+            if (patches.xy.empty()) continue;
+
+            const vector<float> &offsets = placements[it->first];
+            renderer.DrawPatches(&patches.xy[0], &patches.rgb[0], patches.xy.size() / 8,
+                                 uniforms, &offsets[0], offsets.size() / 2);
+        }
+    }
+    double milliseconds = chrono::duration<double, milli>(Clock::now() - start).count() / TIMED_RENDERS;
+
+    if (!renderer.WritePNG(pngFile))
+        return 1;
+
+    cout << pngFile << ": rendered " << size << "x" << size << " in " << milliseconds << " ms" << endl;
+    return 0;
+}
@@ -0,0 +1,226 @@
+// ==========================================================================
+// Signed Distance Field Benchmark
+//
+// Measures how long DistanceField takes to generate the fields of every
+// printable ASCII glyph of each font given, at a few pixel sizes, with
+// glyphs spread across the shared thread pool. A sample of pixels is also
+// checked against the true curves:
+//  - the stored distance against distances to points sampled densely along
+//    the curves, to confirm the grid never hides the nearest segment
+//  - the stored side of the outline against a nonzero winding number found
+//    from where the curves cross the pixel's row, to confirm the sign.
+//    Pixels nearer the outline than one step of the stored values could
+//    round either way, so they are not counted
+// The program fails if any pixel is on the wrong side.
+//
+// Usage: sdfbench <font file> ...
+// ==========================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "Bezier.h"
+#include "DistanceField.h"
+#include "GlyphExtractor.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    const float SIZES[] = { 32.f, 64.f, 128.f };
+    const float RANGE = DEFAULT_DISTANCE_RANGE;
+
+    // check every this many pixels, against curves sampled this many times
+    // per pixel of control polygon length
+    const int CHECK_STRIDE = 7;
+    const int CHECK_SAMPLES = 8;
+
+    void Evaluate(const float *xy, unsigned int degree, float t, float *point)
+    {
+        switch (degree)
+        {
+        case 1:     Bezier<1>::Evaluate(xy, t, point); break;
+        case 2:     Bezier<2>::Evaluate(xy, t, point); break;
+        default:    Bezier<3>::Evaluate(xy, t, point); break;
+        }
+    }
+
+    // distance to the nearest of points sampled along the glyph's curves,
+    // sampling again more finely around the nearest sample of each curve
+    float SampledDistance(const MyGlyph &glyph, float size, float x, float y)
+    {
+        float best = RANGE;
+        for (size_t c = 0; c < glyph.contours.size(); ++c)
+        {
+            for (size_t s = 0; s < glyph.contours[c].size(); ++s)
+            {
+                const MySegment &segment = glyph.contours[c][s];
+                if (segment.degree < 1 || segment.degree > 3) continue;
+
+                float xy[8], length = 0.f;
+                for (unsigned int i = 0; i <= segment.degree; ++i)
+                {
+                    xy[2*i] = size * segment.x[i];
+                    xy[2*i + 1] = size * segment.y[i];
+                    if (i > 0) length += hypot(xy[2*i] - xy[2*i - 2], xy[2*i + 1] - xy[2*i - 1]);
+                }
+
+                int samples = int(CHECK_SAMPLES * length) + 1;
+                float nearest = 0.f, distance = RANGE * 2.f;
+                for (int k = 0; k <= samples; ++k)
+                {
+                    float t = float(k) / samples, point[2];
+                    Evaluate(xy, segment.degree, t, point);
+                    float d = hypot(point[0] - x, point[1] - y);
+                    if (d < distance) {
+                        distance = d;
+                        nearest = t;
+                    }
+                }
+                for (int k = -CHECK_SAMPLES; k <= CHECK_SAMPLES; ++k)
+                {
+                    float t = min(max(nearest + float(k) / (CHECK_SAMPLES * samples), 0.f), 1.f), point[2];
+                    Evaluate(xy, segment.degree, t, point);
+                    distance = min(distance, hypot(point[0] - x, point[1] - y));
+                }
+                best = min(best, distance);
+            }
+        }
+        return best;
+    }
+
+    // bisects a segment's crossing of the line at height y between t0 and
+    // t1, and returns its x
+    float CrossingX(const float *xy, unsigned int degree, float y, float t0, float t1)
+    {
+        float point[2];
+        Evaluate(xy, degree, t0, point);
+        bool above0 = point[1] > y;
+        for (int i = 0; i < 32; ++i)
+        {
+            float t = 0.5f * (t0 + t1);
+            Evaluate(xy, degree, t, point);
+            if ((point[1] > y) == above0) t0 = t;
+            else t1 = t;
+        }
+        Evaluate(xy, degree, 0.5f * (t0 + t1), point);
+        return point[0];
+    }
+
+    // nonzero winding number of the glyph's curves around a point, counting
+    // the curves that cross the ray to its right. Each curve is cut into
+    // pieces short enough that the ray crosses a piece at most once, unless
+    // the point is within a fraction of a pixel of the outline
+    int WindingNumber(const MyGlyph &glyph, float size, float x, float y)
+    {
+        int winding = 0;
+        for (size_t c = 0; c < glyph.contours.size(); ++c)
+        {
+            for (size_t s = 0; s < glyph.contours[c].size(); ++s)
+            {
+                const MySegment &segment = glyph.contours[c][s];
+                if (segment.degree < 1 || segment.degree > 3) continue;
+
+                float xy[8], length = 0.f;
+                for (unsigned int i = 0; i <= segment.degree; ++i)
+                {
+                    xy[2*i] = size * segment.x[i];
+                    xy[2*i + 1] = size * segment.y[i];
+                    if (i > 0) length += hypot(xy[2*i] - xy[2*i - 2], xy[2*i + 1] - xy[2*i - 1]);
+                }
+
+                int pieces = int(CHECK_SAMPLES * length) + 1;
+                float point[2];
+                Evaluate(xy, segment.degree, 0.f, point);
+                bool above = point[1] > y;
+                for (int k = 1; k <= pieces; ++k)
+                {
+                    float t = float(k) / pieces;
+                    Evaluate(xy, segment.degree, t, point);
+                    bool next = point[1] > y;
+                    if (next != above
+                        && CrossingX(xy, segment.degree, y, float(k - 1) / pieces, t) > x)
+                        winding += next ? 1 : -1;
+                    above = next;
+                }
+            }
+        }
+        return winding;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <font file> ..." << endl;
+        return 1;
+    }
+
+    vector<vector<MyGlyph> > fonts;
+    for (int f = 1; f < argc; ++f)
+    {
+        GlyphExtractor extractor;
+        if (!extractor.LoadFontFile(argv[f])) return 1;
+
+        fonts.push_back(vector<MyGlyph>());
+        for (int c = 32; c < 127; ++c)
+            fonts.back().push_back(extractor.ExtractGlyph(c));
+    }
+    cout << fonts.size() << " fonts, " << fonts.size() * 95 << " glyphs, range "
+         << RANGE << " px, " << ThreadPool::Shared().Size() << " threads" << endl;
+
+    bool failed = false;
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); ++s)
+    {
+        float size = SIZES[s];
+        vector<vector<DistanceField> > fields(fonts.size());
+
+        Clock::time_point start = Clock::now();
+        for (size_t f = 0; f < fonts.size(); ++f)
+            GenerateDistanceFields(fonts[f], size, RANGE, fields[f]);
+        double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+        double pixels = 0.0;
+        for (size_t f = 0; f < fields.size(); ++f)
+            for (size_t g = 0; g < fields[f].size(); ++g)
+                pixels += fields[f][g].pixels.size();
+
+        // spot check the first font against the true curves
+        float worst = 0.f;
+        size_t checked = 0, wrongSide = 0;
+        for (size_t g = 0; g < fonts[0].size(); ++g)
+        {
+            const DistanceField &field = fields[0][g];
+            for (size_t i = g % CHECK_STRIDE; i < field.pixels.size(); i += CHECK_STRIDE)
+            {
+                float x = field.left + int(i % field.width) + 0.5f;
+                float y = field.top - int(i / field.width) - 0.5f;
+                float stored = (field.pixels[i] - 127.5f) / 127.5f * RANGE;
+                float distance = SampledDistance(fonts[0][g], size, x, y);
+                worst = max(worst, fabs(fabs(stored) - distance));
+
+                if (distance < RANGE / 127.5f) continue;
+                ++checked;
+                bool inside = WindingNumber(fonts[0][g], size, x, y) != 0;
+                if ((stored > 0.f) != inside) ++wrongSide;
+            }
+        }
+        failed = failed || wrongSide > 0;
+
+        cout << size << " px: " << 1e3 * seconds << " ms, "
+             << pixels / seconds / 1e6 << " M pixels/s, largest distance error in the first font "
+             << worst << " px, " << wrongSide << " of " << checked
+             << " pixels on the wrong side" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+// ==========================================================================
+// Tessellation Level Check
+//
+// Checks the CPU reference of the tessellation control shader (see
+// Tessellation.h) over every glyph in the fonts given. Each glyph is elevated
+// to cubic patches and placed in a 1024 pixel window at each text scale of
+// the main program, then every patch is given the level the shader would
+// pick. The polyline of that many steps must stay within the pixel error of
+// the curve, except for patches whose level is clamped to the maximum. The
+// vertices the tessellator emits are totalled for each scale.
+//
+// Usage: tessbench <font file> ...
+// ==========================================================================
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Bezier.h"
+#include "GlyphExtractor.h"
+#include "Tessellation.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    // the distinct text scales of the main program, and its window size
+    const float SCALES[] = { 0.215f, 0.24f, 0.25f, 0.26f, 0.27f, 0.28f, 0.29f, 0.3f };
+    const float WINDOW_PIXELS = 1024.f;
+
+    struct Totals
+    {
+        size_t  patches;
+        size_t  vertices;
+        size_t  clamped;
+        size_t  failed;
+        float   worstPixels;
+
+        Totals() : patches(0), vertices(0), clamped(0), failed(0), worstPixels(0.f)
+        {}
+    };
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <font file> ..." << endl;
+        return 1;
+    }
+
+    // every glyph of every font as cubic patches, in EM units
+    vector<float> patches;
+    for (int f = 1; f < argc; ++f)
+    {
+        GlyphExtractor extractor;
+        if (!extractor.LoadFontFile(argv[f]))
+            return 1;
+
+        vector<int> characters = extractor.CharacterCodes();
+        if (characters.empty()) continue;
+
+        vector<MyPackedGlyph> glyphs = extractor.ExtractPackedGlyphs(&characters[0], characters.size());
+        for (size_t g = 0; g < glyphs.size(); ++g)
+            AppendCubics(glyphs[g], patches);
+    }
+    size_t count = patches.size() / 8;
+
+    cout << count << " patches, " << DEFAULT_PIXEL_ERROR << " pixel error, "
+         << WINDOW_PIXELS << " pixel window" << endl;
+    cout << setw(8) << "scale" << setw(12) << "vertices" << setw(12) << "per patch"
+         << setw(10) << "clamped" << setw(12) << "worst px" << setw(10) << "failed" << endl;
+
+    bool passed = true;
+    for (size_t s = 0; s < sizeof(SCALES) / sizeof(SCALES[0]); ++s)
+    {
+        // the placement offset moves every point alike, so only the scale
+        // matters to levels and errors
+        vector<float> clip(patches.size());
+        for (size_t i = 0; i < patches.size(); ++i)
+            clip[i] = patches[i] * SCALES[s];
+        vector<float> pixels(patches.size());
+        if (count > 0)
+            ClipToPixels(&clip[0], 4 * count, WINDOW_PIXELS, WINDOW_PIXELS, &pixels[0]);
+
+        Totals totals;
+        totals.patches = count;
+        if (count > 0)
+            totals.vertices = TessellatedVertexCount(&pixels[0], count, DEFAULT_PIXEL_ERROR);
+
+        for (size_t p = 0; p < count; ++p)
+        {
+            const float *patch = &pixels[8*p];
+            int level = CubicTessellationLevel(patch, DEFAULT_PIXEL_ERROR);
+            if (level == MAX_TESSELLATION_LEVEL)
+            {
+                ++totals.clamped;
+                continue;
+            }
+
+            float error = CubicTessellationError(patch, level);
+            totals.worstPixels = max(totals.worstPixels, error);
+            if (error > DEFAULT_PIXEL_ERROR) ++totals.failed;
+        }
+        passed = passed && totals.failed == 0;
+
+        cout << fixed << setprecision(3) << setw(8) << SCALES[s]
+             << setw(12) << totals.vertices
+             << setprecision(2) << setw(12) << double(totals.vertices) / max(count, size_t(1))
+             << setw(10) << totals.clamped
+             << setprecision(4) << setw(12) << totals.worstPixels
+             << setw(10) << totals.failed << endl;
+    }
+
+    return passed ? 0 : 1;
+}
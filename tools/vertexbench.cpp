@@ -0,0 +1,181 @@
+// ==========================================================================
+// Vertex Format Comparison
+//
+// Compares the memory and vertex fetch bandwidth of three layouts of curve
+// geometry, for each font given and the four phrases of the main program:
+// separate float position and colour arrays of degree-elevated patches, the
+// packed vertex format (see VertexFormat.h), and packed vertices shared
+// between patches through 16-bit indices (see IndexedPatches.h). Each
+// phrase is built the way the main program builds it: every distinct glyph
+// once, in a buffer the phrase's characters draw instances from.
+//  - resident bytes are what the buffers of a phrase's glyphs hold
+//  - fetched bytes are what one frame reads, counting every instance; an
+//    indexed glyph reads its indices, and each of its points once
+//  - the error is the furthest a packed control point lands from its float
+//    position, in pixels at the main program's usual text scale
+//
+// Usage: vertexbench <font file> ...
+// ==========================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Bezier.h"
+#include "GlyphExtractor.h"
+#include "IndexedPatches.h"
+#include "VertexFormat.h"
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+    const char *PHRASES[] = {
+        "Cameron Hardy",
+        "The quick brown fox jumps over the lazy dog.",
+        "A phrase!",
+        "there is no need to be upset"
+    };
+
+    // bytes per control point of the float layout: vec2 position, vec3 colour
+    const size_t FLOAT_VERTEX_BYTES = 2 * sizeof(float) + 3 * sizeof(float);
+
+    // text scale and window size of the main program, for errors in pixels
+    const float TEXT_SCALE = 0.25f;
+    const float WINDOW_PIXELS = 1024.f;
+
+    // points and indices of a glyph in the indexed layout
+    struct IndexedGlyph
+    {
+        size_t  points;
+        size_t  indices;
+    };
+
+    struct Totals
+    {
+        size_t  residentPoints;
+        size_t  fetchedPoints;
+        size_t  indexedBytes;
+        size_t  fetchedIndexedBytes;
+        float   worstPixels;
+
+        Totals()
+            : residentPoints(0), fetchedPoints(0), indexedBytes(0), fetchedIndexedBytes(0),
+              worstPixels(0.f)
+        {}
+    };
+
+    size_t IndexedBytes(size_t points, size_t indices)
+    {
+        return points * sizeof(PackedVertex) + indices * sizeof(unsigned short);
+    }
+
+    void PrintRow(const string &name, const Totals &totals)
+    {
+        cout << setw(30) << left << name << right << fixed << setprecision(1)
+             << setw(9) << totals.residentPoints * FLOAT_VERTEX_BYTES / 1024.0
+             << setw(9) << totals.residentPoints * sizeof(PackedVertex) / 1024.0
+             << setw(9) << totals.indexedBytes / 1024.0
+             << setw(10) << totals.fetchedPoints * FLOAT_VERTEX_BYTES / 1024.0
+             << setw(10) << totals.fetchedPoints * sizeof(PackedVertex) / 1024.0
+             << setw(10) << totals.fetchedIndexedBytes / 1024.0
+             << setprecision(4) << setw(10) << totals.worstPixels << endl;
+    }
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <font file> ..." << endl;
+        return 1;
+    }
+
+    cout << FLOAT_VERTEX_BYTES << " bytes per float vertex, " << sizeof(PackedVertex)
+         << " per packed vertex; sizes in KiB over " << sizeof(PHRASES) / sizeof(PHRASES[0])
+         << " phrases" << endl;
+    cout << setw(30) << left << "font" << right
+         << setw(9) << "float" << setw(9) << "packed" << setw(9) << "indexed"
+         << setw(10) << "float/fr" << setw(10) << "packed/fr" << setw(10) << "index/fr"
+         << setw(10) << "error px" << endl;
+
+    Totals all;
+    for (int f = 1; f < argc; ++f)
+    {
+        GlyphExtractor extractor;
+        if (!extractor.LoadFontFile(argv[f]))
+            return 1;
+
+        Totals font;
+        for (size_t p = 0; p < sizeof(PHRASES) / sizeof(PHRASES[0]); ++p)
+        {
+            string phrase = PHRASES[p];
+
+            // each glyph of the phrase once, and how often it is drawn
+            vector<float> xy;
+            IndexedPatches indexed;
+            map<char, size_t> points;
+            map<char, IndexedGlyph> indexedGlyphs;
+            for (size_t i = 0; i < phrase.size(); ++i)
+            {
+                char c = phrase[i];
+                if (!points.count(c))
+                {
+                    IndexedGlyph glyph = { indexed.PointCount(), indexed.IndexCount() };
+                    MyPackedGlyph packed = extractor.ExtractPackedGlyph(c);
+                    points[c] = AppendCubics(packed, xy) * 4;
+                    for (unsigned int d = 1; d <= 3; ++d)
+                    {
+                        // colours don't affect sizes, so any will do
+                        size_t count = packed.SegmentCount(d);
+                        vector<float> rgb(3 * (d + 1) * count, 0.5f);
+                        if (count > 0)
+                            indexed.AddSegments(d, packed.Points(d), &rgb[0], count);
+                    }
+                    glyph.points = indexed.PointCount() - glyph.points;
+                    glyph.indices = indexed.IndexCount() - glyph.indices;
+                    indexedGlyphs[c] = glyph;
+                }
+                font.fetchedPoints += points[c];
+                font.fetchedIndexedBytes += IndexedBytes(indexedGlyphs[c].points, indexedGlyphs[c].indices);
+            }
+
+            size_t count = xy.size() / 2;
+            font.residentPoints += count;
+            font.indexedBytes += IndexedBytes(indexed.PointCount(), indexed.IndexCount());
+            if (count == 0) continue;
+
+            // colours don't affect positions, so any will do
+            vector<float> rgb(3 * count, 0.5f);
+            vector<PackedVertex> vertices(count);
+            float scale = PositionScale(&xy[0], count);
+            PackVertices(&xy[0], &rgb[0], count, scale, &vertices[0]);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                float unpacked[2];
+                UnpackPosition(vertices[i], scale, unpacked);
+                float error = hypot(unpacked[0] - xy[2*i], unpacked[1] - xy[2*i + 1]);
+                font.worstPixels = max(font.worstPixels, error * TEXT_SCALE * WINDOW_PIXELS / 2.f);
+            }
+        }
+
+        string name = argv[f];
+        PrintRow(name.substr(name.find_last_of('/') + 1), font);
+
+        all.residentPoints += font.residentPoints;
+        all.fetchedPoints += font.fetchedPoints;
+        all.indexedBytes += font.indexedBytes;
+        all.fetchedIndexedBytes += font.fetchedIndexedBytes;
+        all.worstPixels = max(all.worstPixels, font.worstPixels);
+    }
+    PrintRow("all", all);
+    return 0;
+}
@@ -7,21 +7,41 @@
 #version 410
 
 // location indices for these attributes correspond to those specified in the
-// InitializeGeometry() function of the main program
+// RenderGeometry() and RenderInstancedGeometry() functions of the main program;
+// positions arrive as normalized 16-bit integers and colours as 8-bit RGBA
+// (see VertexFormat.h)
 layout(location = 0) in vec2 VertexPosition;
-layout(location = 1) in vec3 VertexColour;
+layout(location = 1) in vec4 VertexColour;
+
+// per-instance offset of a glyph within the text; geometry that is not drawn
+// instanced leaves this attribute disabled, so it reads as zero
+layout(location = 2) in vec2 InstanceOffset;
+
+// per-instance colour of a control point marker, which multiplies the
+// marker's white; everything else reads a constant white here
+layout(location = 3) in vec4 InstanceColour;
 
 // output to be interpolated between vertices and passed to the fragment stage
 out vec3 tcColour;
 
-uniform vec2 offset = vec2(0,0);
-uniform vec2 scrollOffset = vec2(0,0);
-uniform float scale = 1;
+// placement shared by every draw, set by the main program in one buffer;
+// the same block is declared in tessControl.glsl
+layout(std140) uniform Transform
+{
+    vec2 offset;
+    vec2 scrollOffset;
+    vec2 viewport;      // in pixels
+    float scale;
+};
+
+// brings packed positions from -1..1 back to the geometry's own units
+uniform float positionScale = 1;
+
 void main()
 {
     // assign vertex position without modification
-    gl_Position = vec4(scale * VertexPosition + offset + scrollOffset, 0.0, 1.0);
+    gl_Position = vec4(scale * (positionScale * VertexPosition + InstanceOffset) + offset + scrollOffset, 0.0, 1.0);
 
     // assign output colour to be interpolated
-    tcColour = VertexColour;
+    tcColour = VertexColour.rgb * InstanceColour.rgb;
 }